@@ -42,6 +42,71 @@ static void BM_lexer(benchmark::State& state)
 }
 BENCHMARK(BM_lexer);
 
+static void BM_lexer_from_string_view(benchmark::State& state)
+{
+  std::ifstream fin("benchmarks/test.sexp");
+  if (!fin)
+  {
+    throw std::runtime_error("failed to open benchmarks/test.sexp");
+  }
+  std::string const text((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+
+  while (state.KeepRunning())
+  {
+    sexp::Lexer lexer(text);
+    while(lexer.get_next_token() != sexp::Lexer::TOKEN_EOF) {}
+  }
+}
+BENCHMARK(BM_lexer_from_string_view);
+
+static void BM_lexer_numbers(benchmark::State& state)
+{
+  std::string text = "(";
+  for(int i = 0; i < 100000; ++i) {
+    text += std::to_string(i * 7919 - 300000) + " " + std::to_string(i) + ".25 ";
+  }
+  text += ")";
+
+  while (state.KeepRunning())
+  {
+    std::istringstream is(text);
+    sexp::Lexer lexer(is);
+    long sum = 0;
+    while(true)
+    {
+      sexp::Lexer::TokenType const token = lexer.get_next_token();
+      if (token == sexp::Lexer::TOKEN_INTEGER) {
+        sum += lexer.get_integer();
+      } else if (token == sexp::Lexer::TOKEN_REAL) {
+        sum += static_cast<long>(lexer.get_real());
+      } else if (token == sexp::Lexer::TOKEN_EOF) {
+        break;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(BM_lexer_numbers);
+
+static void BM_lexer_strings_and_comments(benchmark::State& state)
+{
+  std::string text;
+  for(int i = 0; i < 2000; ++i) {
+    text += ";; ---------------------------------------------------------------------------\n"
+            ";; a longer comment header as it is found at the start of asset files\n"
+            "(image \"images/tiles/forest/ground/forest-ground-" + std::to_string(i) + "-large.png\")\n";
+  }
+
+  while (state.KeepRunning())
+  {
+    std::istringstream is(text);
+    sexp::Lexer lexer(is);
+    while(lexer.get_next_token() != sexp::Lexer::TOKEN_EOF) {}
+  }
+}
+BENCHMARK(BM_lexer_strings_and_comments);
+
 BENCHMARK_MAIN();
 
 /* EOF */
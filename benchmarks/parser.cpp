@@ -21,8 +21,17 @@
 #include <fstream>
 #include <sstream>
 #include <streambuf>
+#include <vector>
 
+#include "sexp/arena.hpp"
+#include "sexp/event_parser.hpp"
+#include "sexp/lazy_document.hpp"
+#include "sexp/parse_context.hpp"
 #include "sexp/parser.hpp"
+#include "sexp/push_parser.hpp"
+#include "sexp/reader.hpp"
+#include "sexp/tape_document.hpp"
+#include "sexp/util.hpp"
 
 static void BM_parser(benchmark::State& state)
 {
@@ -58,6 +67,479 @@ static void BM_parser_use_arrays(benchmark::State& state)
 }
 BENCHMARK(BM_parser_use_arrays);
 
+static void BM_parser_real_array(benchmark::State& state)
+{
+  std::string text = "(";
+  for(int i = 0; i < 10000; ++i)
+  {
+    text += std::to_string(i) + ".5 ";
+  }
+  text += ")";
+
+  while (state.KeepRunning())
+  {
+    sexp::Lexer lexer(text, sexp::Parser::USE_ARRAYS);
+    sexp::Parser parser(lexer);
+    parser.set_typed_arrays(true);
+    sexp::Value sx = parser.read();
+    benchmark::DoNotOptimize(sx);
+  }
+}
+BENCHMARK(BM_parser_real_array);
+
+static void BM_parser_from_string_view(benchmark::State& state)
+{
+  std::ifstream fin("benchmarks/test.sexp");
+  if (!fin)
+  {
+    throw std::runtime_error("failed to open benchmarks/test.sexp");
+  }
+  std::string const text((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+
+  while (state.KeepRunning())
+  {
+    sexp::Value sx = sexp::Parser::from_string_view(text);
+  }
+}
+BENCHMARK(BM_parser_from_string_view);
+
+static void BM_parser_without_line_numbers(benchmark::State& state)
+{
+  std::ifstream fin("benchmarks/test.sexp");
+  if (!fin)
+  {
+    throw std::runtime_error("failed to open benchmarks/test.sexp");
+  }
+  std::string const text((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+
+  while (state.KeepRunning())
+  {
+    sexp::Lexer lexer(text);
+    sexp::Parser parser(lexer);
+    parser.set_line_numbers(false);
+    std::vector<sexp::Value> values = parser.read_many();
+    benchmark::DoNotOptimize(values);
+  }
+}
+BENCHMARK(BM_parser_without_line_numbers);
+
+static void BM_push_parser(benchmark::State& state)
+{
+  // a stream of small messages, as they would come from a socket
+  std::string text;
+  for(int i = 0; i < 10000; ++i)
+  {
+    text += "(message (id " + std::to_string(i) + ") (name \"entry\") (pos 1.5 -2.5))\n";
+  }
+
+  size_t const chunk_size = 1500;
+  while (state.KeepRunning())
+  {
+    sexp::PushParser parser;
+    sexp::Value value;
+    for(size_t pos = 0; pos < text.size(); pos += chunk_size)
+    {
+      parser.feed(std::string_view(text).substr(pos, chunk_size));
+      while(parser.next(value)) {
+        benchmark::DoNotOptimize(value);
+      }
+    }
+    parser.finish();
+  }
+}
+BENCHMARK(BM_push_parser);
+
+static void BM_push_parser_reference(benchmark::State& state)
+{
+  std::string text;
+  for(int i = 0; i < 10000; ++i)
+  {
+    text += "(message (id " + std::to_string(i) + ") (name \"entry\") (pos 1.5 -2.5))\n";
+  }
+
+  while (state.KeepRunning())
+  {
+    std::vector<sexp::Value> values = sexp::Parser::from_string_view_many(text);
+    benchmark::DoNotOptimize(values);
+  }
+}
+BENCHMARK(BM_push_parser_reference);
+
+namespace {
+
+std::vector<std::string> make_messages()
+{
+  std::vector<std::string> messages;
+  for(int i = 0; i < 1000; ++i)
+  {
+    messages.push_back("(message (id " + std::to_string(i) + ") (name \"entry\") (pos 1.5 -2.5))");
+  }
+  return messages;
+}
+
+} // namespace
+
+static void BM_parse_context(benchmark::State& state)
+{
+  std::vector<std::string> const messages = make_messages();
+  sexp::ParseContext ctx;
+  while (state.KeepRunning())
+  {
+    for(auto const& message : messages)
+    {
+      std::istringstream is(message);
+      sexp::Value value = ctx.from_stream(is);
+      benchmark::DoNotOptimize(value);
+    }
+  }
+}
+BENCHMARK(BM_parse_context);
+
+static void BM_parse_context_reference(benchmark::State& state)
+{
+  std::vector<std::string> const messages = make_messages();
+  while (state.KeepRunning())
+  {
+    for(auto const& message : messages)
+    {
+      std::istringstream is(message);
+      sexp::Value value = sexp::Parser::from_stream(is);
+      benchmark::DoNotOptimize(value);
+    }
+  }
+}
+BENCHMARK(BM_parse_context_reference);
+
+static void BM_parse_context_arena(benchmark::State& state)
+{
+  std::vector<std::string> const messages = make_messages();
+  sexp::Arena arena;
+  sexp::ParseContext ctx(arena);
+  while (state.KeepRunning())
+  {
+    for(auto const& message : messages)
+    {
+      {
+        sexp::Value value = ctx.from_string_view(message);
+        benchmark::DoNotOptimize(value);
+      }
+      arena.clear();
+    }
+  }
+}
+BENCHMARK(BM_parse_context_arena);
+
+static void BM_parse_context_arena_reference(benchmark::State& state)
+{
+  std::vector<std::string> const messages = make_messages();
+  while (state.KeepRunning())
+  {
+    for(auto const& message : messages)
+    {
+      sexp::Arena arena;
+      sexp::Value value = sexp::Parser::from_string_view(message, arena);
+      benchmark::DoNotOptimize(value);
+    }
+  }
+}
+BENCHMARK(BM_parse_context_arena_reference);
+
+static void BM_parser_from_file(benchmark::State& state)
+{
+  while (state.KeepRunning())
+  {
+    sexp::Value sx = sexp::Parser::from_file("benchmarks/test.sexp");
+  }
+}
+BENCHMARK(BM_parser_from_file);
+
+static void BM_parser_arena(benchmark::State& state)
+{
+  std::ifstream fin("benchmarks/test.sexp");
+  if (!fin)
+  {
+    throw std::runtime_error("failed to open benchmarks/test.sexp");
+  }
+  std::string const text((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+
+  while (state.KeepRunning())
+  {
+    sexp::Arena arena;
+    sexp::Value sx = sexp::Parser::from_string_view(text, arena);
+  }
+}
+BENCHMARK(BM_parser_arena);
+
+namespace {
+
+struct CountingHandler : public sexp::EventHandler
+{
+  int count = 0;
+  void on_symbol(std::string_view, int) { count += 1; }
+  void on_integer(int, int) { count += 1; }
+  void on_real(float, int) { count += 1; }
+};
+
+} // namespace
+
+static void BM_event_parser(benchmark::State& state)
+{
+  std::ifstream fin("benchmarks/test.sexp");
+  if (!fin)
+  {
+    throw std::runtime_error("failed to open benchmarks/test.sexp");
+  }
+  std::string const text((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+
+  while (state.KeepRunning())
+  {
+    CountingHandler handler;
+    sexp::EventParser<CountingHandler>::from_string_view(text, handler);
+    benchmark::DoNotOptimize(handler.count);
+  }
+}
+BENCHMARK(BM_event_parser);
+
+static void BM_reader_find(benchmark::State& state)
+{
+  std::ifstream fin("benchmarks/test.sexp");
+  if (!fin)
+  {
+    throw std::runtime_error("failed to open benchmarks/test.sexp");
+  }
+  std::string const text((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+
+  // pick (name ...) out of the level and skip everything else
+  while (state.KeepRunning())
+  {
+    sexp::Lexer lexer(text);
+    sexp::Reader reader(lexer);
+    reader.next();
+    reader.enter();
+    while(reader.next())
+    {
+      if (reader.is_list())
+      {
+        reader.enter();
+        if (reader.next() && reader.is_symbol() && reader.get_string_view() == "name")
+        {
+          reader.next();
+          sexp::Value sx = reader.materialize();
+        }
+        reader.leave();
+      }
+    }
+  }
+}
+BENCHMARK(BM_reader_find);
+
+static void BM_lazy_document_find(benchmark::State& state)
+{
+  std::ifstream fin("benchmarks/test.sexp");
+  if (!fin)
+  {
+    throw std::runtime_error("failed to open benchmarks/test.sexp");
+  }
+  std::string const text((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+
+  while (state.KeepRunning())
+  {
+    sexp::LazyDocument doc(text);
+    sexp::Value const& sx = sexp::assoc_ref(doc.get_root().get_cdr(), "name").get();
+    benchmark::DoNotOptimize(&sx);
+  }
+}
+BENCHMARK(BM_lazy_document_find);
+
+static void BM_parser_many(benchmark::State& state)
+{
+  std::ifstream fin("benchmarks/test.sexp");
+  if (!fin)
+  {
+    throw std::runtime_error("failed to open benchmarks/test.sexp");
+  }
+  std::string const level((std::istreambuf_iterator<char>(fin)),
+                          std::istreambuf_iterator<char>());
+  std::string text;
+  for(int i = 0; i < 64; ++i)
+  {
+    text += level;
+  }
+
+  unsigned const num_threads = static_cast<unsigned>(state.range(0));
+  while (state.KeepRunning())
+  {
+    std::vector<sexp::Value> sx = sexp::Parser::from_string_view_many_parallel(text, false, num_threads);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(text.size()));
+}
+BENCHMARK(BM_parser_many)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+static void BM_parser_threads(benchmark::State& state)
+{
+  std::ifstream fin("benchmarks/test.sexp");
+  if (!fin)
+  {
+    throw std::runtime_error("failed to open benchmarks/test.sexp");
+  }
+  std::string const text((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+
+  while (state.KeepRunning())
+  {
+    sexp::Value sx = sexp::Parser::from_string_view(text);
+  }
+}
+BENCHMARK(BM_parser_threads)->Threads(1)->Threads(4)->UseRealTime();
+
+static void BM_cons_alloc(benchmark::State& state)
+{
+  while (state.KeepRunning())
+  {
+    sexp::Value sx;
+    for(int i = 0; i < 1000; ++i) {
+      sx = sexp::Value::cons(sexp::Value::integer(i), std::move(sx));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_cons_alloc)->Threads(1)->Threads(4)->UseRealTime();
+
+static void BM_copy(benchmark::State& state)
+{
+  std::ifstream fin("benchmarks/test.sexp");
+  if (!fin)
+  {
+    throw std::runtime_error("failed to open benchmarks/test.sexp");
+  }
+  sexp::Value const sx = sexp::Parser::from_stream(fin);
+
+  while (state.KeepRunning())
+  {
+    sexp::Value copy = sx; // NOLINT
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_copy);
+
+static void BM_copy_shared(benchmark::State& state)
+{
+  std::ifstream fin("benchmarks/test.sexp");
+  if (!fin)
+  {
+    throw std::runtime_error("failed to open benchmarks/test.sexp");
+  }
+  sexp::Value sx = sexp::Parser::from_stream(fin);
+  sx.share();
+
+  while (state.KeepRunning())
+  {
+    sexp::Value copy = sx; // NOLINT
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_copy_shared);
+
+static void BM_tape_document(benchmark::State& state)
+{
+  std::ifstream fin("benchmarks/test.sexp");
+  if (!fin)
+  {
+    throw std::runtime_error("failed to open benchmarks/test.sexp");
+  }
+  std::string const text((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+
+  while (state.KeepRunning())
+  {
+    sexp::TapeDocument doc = sexp::TapeDocument::from_string_view(text);
+    benchmark::DoNotOptimize(doc.size());
+  }
+}
+BENCHMARK(BM_tape_document);
+
+namespace {
+
+int sum_integers(sexp::Value const& sx)
+{
+  int sum = 0;
+  if (sx.is_cons())
+  {
+    for(sexp::Value const& item : sexp::ListAdapter(sx))
+    {
+      sum += sum_integers(item);
+    }
+  }
+  else if (sx.is_integer())
+  {
+    sum += sx.as_int();
+  }
+  return sum;
+}
+
+int sum_integers(sexp::NodeRef const& sx)
+{
+  int sum = 0;
+  if (sx.is_cons())
+  {
+    for(sexp::NodeRef const& item : sexp::NodeListAdapter(sx))
+    {
+      sum += sum_integers(item);
+    }
+  }
+  else if (sx.is_integer())
+  {
+    sum += sx.as_int();
+  }
+  return sum;
+}
+
+} // namespace
+
+static void BM_scan_value(benchmark::State& state)
+{
+  sexp::Value const sx = sexp::Parser::from_file("benchmarks/test.sexp");
+  while (state.KeepRunning())
+  {
+    benchmark::DoNotOptimize(sum_integers(sx));
+  }
+}
+BENCHMARK(BM_scan_value);
+
+static void BM_scan_tape(benchmark::State& state)
+{
+  sexp::TapeDocument const doc = sexp::TapeDocument::from_file("benchmarks/test.sexp");
+  while (state.KeepRunning())
+  {
+    benchmark::DoNotOptimize(sum_integers(doc.get_root()));
+  }
+}
+BENCHMARK(BM_scan_tape);
+
+static void BM_scan_tape_sequential(benchmark::State& state)
+{
+  sexp::TapeDocument const doc = sexp::TapeDocument::from_file("benchmarks/test.sexp");
+  while (state.KeepRunning())
+  {
+    int sum = 0;
+    for(sexp::NodeRef const& node : sexp::NodeTreeAdapter(doc.get_root()))
+    {
+      if (node.is_integer())
+      {
+        sum += node.as_int();
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(BM_scan_tape_sequential);
+
 BENCHMARK_MAIN();
 
 /* EOF */
@@ -0,0 +1,97 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_ARENA_HPP
+#define HEADER_SEXP_ARENA_HPP
+
+#include <memory>
+#include <memory_resource>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace sexp {
+
+/** Monotonic bump allocator for parse trees. Memory is taken from
+    large chunks and only given back when the Arena is destroyed, so
+    building a tree costs a pointer increment per node and releasing
+    it is a handful of free() calls. Values allocated from an Arena
+    must not outlive it, copies of them are regular heap Values. As a
+    std::pmr::memory_resource it also holds the characters of long
+    strings and the elements of arrays, deallocate() does nothing. An
+    Arena is not thread-safe. */
+class Arena : public std::pmr::memory_resource
+{
+public:
+  static const size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+  Arena(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+  ~Arena() override;
+
+  inline void* allocate(size_t size, size_t alignment)
+  {
+    uintptr_t const pos = (reinterpret_cast<uintptr_t>(m_pos) + alignment - 1) & ~(alignment - 1);
+    if (pos + size > reinterpret_cast<uintptr_t>(m_end))
+    {
+      return allocate_slow(size, alignment);
+    }
+    m_pos = reinterpret_cast<char*>(pos + size);
+    return reinterpret_cast<void*>(pos);
+  }
+
+  /** Construct a T in the Arena, its destructor is never called by
+      the Arena itself */
+  template<typename T, typename... Args>
+  T* create(Args&&... args)
+  {
+    return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  /** Release everything allocated so far, Values allocated from the
+      Arena must be gone by then. One chunk is kept, so refilling the
+      Arena with a tree of similar size doesn't go back to the
+      system. */
+  void clear();
+
+  /** Number of bytes taken from the system, including unused space
+      at the end of chunks */
+  size_t get_capacity() const { return m_capacity; }
+
+private:
+  void* do_allocate(size_t size, size_t alignment) override { return allocate(size, alignment); }
+  void do_deallocate(void*, size_t, size_t) override {}
+  bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override { return this == &other; }
+
+  void* allocate_slow(size_t size, size_t alignment);
+
+private:
+  size_t m_chunk_size;
+  size_t m_capacity;
+  char* m_pos;
+  char* m_end;
+  std::vector<std::unique_ptr<char[]> > m_chunks;
+
+private:
+  Arena(const Arena&);
+  Arena & operator=(const Arena&);
+};
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
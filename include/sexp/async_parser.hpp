@@ -0,0 +1,201 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_ASYNC_PARSER_HPP
+#define HEADER_SEXP_ASYNC_PARSER_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <coroutine>
+#include <span>
+#include <stdexcept>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <sexp/push_parser.hpp>
+#include <sexp/task.hpp>
+#include <sexp/value.hpp>
+
+namespace sexp {
+
+/** What co_await in a Task works with directly, resulting in a value
+    convertible to \a Result */
+template<typename Awaiter, typename Result>
+concept AwaiterOf = requires(Awaiter& awaiter, std::coroutine_handle<> handle) {
+  { awaiter.await_ready() } -> std::convertible_to<bool>;
+  awaiter.await_suspend(handle);
+  { awaiter.await_resume() } -> std::convertible_to<Result>;
+};
+
+/** An AwaiterOf \a Result or something that gives one with a member
+    or free operator co_await() */
+template<typename T, typename Result>
+concept AwaitableOf =
+  AwaiterOf<T, Result> ||
+  requires(T&& value) { { std::forward<T>(value).operator co_await() } -> AwaiterOf<Result>; } ||
+  requires(T&& value) { { operator co_await(std::forward<T>(value)) } -> AwaiterOf<Result>; };
+
+/** Input for AsyncParser. co_await source.read(buffer) fills the
+    beginning of \a buffer and results in the number of bytes read, 0
+    at the end of the input. */
+template<typename Source>
+concept AsyncByteSource = requires(Source& source, std::span<char> buffer) {
+  { source.read(buffer) } -> AwaitableOf<size_t>;
+};
+
+/** AsyncByteSource for text already in memory, read() never
+    suspends. \a text must outlive the source. */
+class StringSource
+{
+public:
+  StringSource(std::string_view text) : m_text(text) {}
+
+  auto read(std::span<char> buffer)
+  {
+    struct Awaiter
+    {
+      size_t size;
+
+      bool await_ready() const noexcept { return true; }
+      void await_suspend(std::coroutine_handle<>) const noexcept {}
+      size_t await_resume() const noexcept { return size; }
+    };
+
+    size_t const size = std::min(buffer.size(), m_text.size());
+    if (size == 0)
+    {
+      return Awaiter{0};
+    }
+    memcpy(buffer.data(), m_text.data(), size);
+    m_text.remove_prefix(size);
+    return Awaiter{size};
+  }
+
+private:
+  std::string_view m_text;
+};
+
+/** Reads the top level forms of an AsyncByteSource without blocking
+    a thread while waiting for input:
+
+      sexp::AsyncParser<Socket> parser(socket);
+      sexp::Value value;
+      while(co_await parser.next(value)) { ... }
+
+    Only the unfinished top level form is kept in memory, see
+    PushParser. */
+template<AsyncByteSource Source>
+class AsyncParser
+{
+public:
+  static constexpr size_t DEFAULT_BUFFER_SIZE = 16384;
+
+  /** \a buffer_size is the size of the reads from \a source */
+  AsyncParser(Source& source, bool use_arrays = false, size_t buffer_size = DEFAULT_BUFFER_SIZE) :
+    m_source(source),
+    m_parser(use_arrays),
+    m_buffer(buffer_size),
+    m_eof(false)
+  {}
+
+  /** Read the next top level form into \a value, completes with false
+      at the end of the input. Parse errors are thrown when the Task is
+      awaited. */
+  Task<bool> next(Value& value)
+  {
+    while(!m_parser.next(value))
+    {
+      if (m_eof) {
+        co_return false;
+      }
+
+      size_t const size = co_await m_source.read(std::span<char>(m_buffer));
+      if (size == 0)
+      {
+        m_eof = true;
+        m_parser.finish();
+      }
+      else
+      {
+        m_parser.feed(m_buffer.data(), size);
+      }
+    }
+    co_return true;
+  }
+
+  /** Line number of the input that hasn't been parsed yet, at the
+      end of the input the number of lines in it */
+  int get_line_number() const { return m_parser.get_line_number(); }
+
+  /** Read all remaining top level forms */
+  Task<std::vector<Value>> read_many()
+  {
+    std::vector<Value> result;
+    Value value;
+    while(co_await next(value)) {
+      result.push_back(std::move(value));
+    }
+    co_return result;
+  }
+
+private:
+  Source& m_source;
+  PushParser m_parser;
+  std::vector<char> m_buffer;
+  bool m_eof;
+
+private:
+  AsyncParser(const AsyncParser&);
+  AsyncParser & operator=(const AsyncParser&);
+};
+
+/** Read a single top level form from \a source, the counterpart of
+    Parser::from_stream() that throws the same errors */
+template<AsyncByteSource Source>
+Task<Value> read_async(Source& source, bool use_arrays = false)
+{
+  AsyncParser<Source> parser(source, use_arrays);
+  Value value;
+  if (!co_await parser.next(value)) {
+    throw std::runtime_error("Parse Error at line " + std::to_string(parser.get_line_number()) +
+                             ": Unexpected EOF.");
+  }
+
+  Value rest;
+  if (co_await parser.next(rest)) {
+    throw std::runtime_error("Parse Error at line " + std::to_string(rest.get_line()) +
+                             ": trailing garbage in stream");
+  }
+  co_return value;
+}
+
+/** Read all top level forms from \a source, the counterpart of
+    Parser::from_stream_many() */
+template<AsyncByteSource Source>
+Task<std::vector<Value>> read_many_async(Source& source, bool use_arrays = false)
+{
+  AsyncParser<Source> parser(source, use_arrays);
+  co_return co_await parser.read_many();
+}
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
@@ -0,0 +1,256 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_EVENT_PARSER_HPP
+#define HEADER_SEXP_EVENT_PARSER_HPP
+
+#include <istream>
+#include <string_view>
+#include <vector>
+
+#include <sexp/lexer.hpp>
+#include <sexp/parser.hpp>
+
+namespace sexp {
+
+/** Handler with empty callbacks, derive from it and provide only the
+    callbacks of interest. \a line is the same line number that
+    Parser would store in the corresponding Value. */
+struct EventHandler
+{
+  void on_list_begin(int /*line*/) {}
+  void on_list_end(int /*line*/) {}
+  void on_array_begin(int /*line*/) {}
+  void on_array_end(int /*line*/) {}
+  void on_dot(int /*line*/) {}
+  void on_symbol(std::string_view /*value*/, int /*line*/) {}
+  void on_string(std::string_view /*value*/, int /*line*/) {}
+  void on_integer(int /*value*/, int /*line*/) {}
+  void on_real(float /*value*/, int /*line*/) {}
+  void on_bool(bool /*value*/, int /*line*/) {}
+};
+
+/** The parts of EventParser that don't depend on the handler */
+class EventParserBase
+{
+protected:
+  enum FrameKind : unsigned char
+  {
+    EMPTY_LIST,  // '(' seen, no element yet
+    LIST,
+    DOT,         // '.' seen, waiting for the last element
+    DOTTED_LIST, // last element seen, waiting for ')'
+    EMPTY_ARRAY, // '#(' seen, no element yet
+    ARRAY
+  };
+
+  EventParserBase(Lexer& lexer, int max_depth);
+  ~EventParserBase();
+
+  [[noreturn]]
+  void parse_error(const char* msg) const;
+
+protected:
+  Lexer& m_lexer;
+  Lexer::TokenType m_token;
+  int m_max_depth;
+
+  /** Open lists and arrays, reused between calls to read() */
+  std::vector<FrameKind> m_stack;
+
+private:
+  EventParserBase(const EventParserBase&);
+  EventParserBase & operator=(const EventParserBase&);
+};
+
+/** Parser that reports the content of the input to \a Handler as it
+    is read instead of building Values, nothing is allocated apart
+    from the nesting stack and the Lexer's token buffer. Strings passed
+    to the handler are only valid for the duration of the callback.
+    Input is checked the same way Parser checks it. The empty list
+    "()" is reported as an on_list_begin() followed by on_list_end(). */
+template<typename Handler>
+class EventParser : private EventParserBase
+{
+public:
+  static void from_string_view(std::string_view str, Handler& handler, bool use_arrays = false)
+  {
+    Lexer lexer(str, use_arrays);
+    EventParser parser(lexer, handler);
+    parser.read_many();
+  }
+
+  static void from_stream(std::istream& stream, Handler& handler, bool use_arrays = false)
+  {
+    Lexer lexer(stream, use_arrays);
+    EventParser parser(lexer, handler);
+    parser.read_many();
+  }
+
+public:
+  EventParser(Lexer& lexer, Handler& handler, int max_depth = Parser::DEFAULT_MAX_DEPTH) :
+    EventParserBase(lexer, max_depth),
+    m_handler(handler)
+  {}
+
+  /** Report the next top level value to the handler, returns false
+      at the end of the input */
+  bool read();
+
+  /** Report values until the end of the input */
+  void read_many()
+  {
+    while(read()) {}
+  }
+
+private:
+  inline void push(FrameKind kind);
+
+private:
+  Handler& m_handler;
+};
+
+template<typename Handler>
+inline void
+EventParser<Handler>::push(FrameKind kind)
+{
+  if (static_cast<int>(m_stack.size()) >= m_max_depth)
+  {
+    parse_error("Nesting too deep.");
+  }
+  m_stack.push_back(kind);
+}
+
+template<typename Handler>
+bool
+EventParser<Handler>::read()
+{
+  if (m_token == Lexer::TOKEN_EOF)
+  {
+    return false;
+  }
+
+  m_stack.clear();
+  do
+  {
+    int const line_number = m_lexer.get_line_number();
+
+    switch(m_token)
+    {
+      case Lexer::TOKEN_OPEN_PAREN:
+        push(EMPTY_LIST);
+        m_handler.on_list_begin(line_number);
+        m_token = m_lexer.get_next_token();
+        continue;
+
+      case Lexer::TOKEN_ARRAY_START:
+        push(EMPTY_ARRAY);
+        m_handler.on_array_begin(line_number);
+        m_token = m_lexer.get_next_token();
+        continue;
+
+      case Lexer::TOKEN_DOT:
+        if (m_stack.empty() || m_stack.back() != LIST)
+        {
+          parse_error("Unexpected '.'.");
+        }
+        m_stack.back() = DOT;
+        m_handler.on_dot(line_number);
+        m_token = m_lexer.get_next_token();
+        continue;
+
+      case Lexer::TOKEN_CLOSE_PAREN:
+        // Parser has no representation for an empty array
+        if (m_stack.empty() || m_stack.back() == DOT || m_stack.back() == EMPTY_ARRAY)
+        {
+          parse_error("Unexpected ')'.");
+        }
+        else if (m_stack.back() == ARRAY)
+        {
+          m_handler.on_array_end(line_number);
+        }
+        else
+        {
+          m_handler.on_list_end(line_number);
+        }
+        m_stack.pop_back();
+        break;
+
+      case Lexer::TOKEN_SYMBOL:
+        m_handler.on_symbol(m_lexer.get_string_view(), line_number);
+        break;
+
+      case Lexer::TOKEN_STRING:
+        m_handler.on_string(m_lexer.get_string_view(), line_number);
+        break;
+
+      case Lexer::TOKEN_INTEGER:
+        m_handler.on_integer(m_lexer.get_integer(), line_number);
+        break;
+
+      case Lexer::TOKEN_REAL:
+        m_handler.on_real(m_lexer.get_real(), line_number);
+        break;
+
+      case Lexer::TOKEN_TRUE:
+        m_handler.on_bool(true, line_number);
+        break;
+
+      case Lexer::TOKEN_FALSE:
+        m_handler.on_bool(false, line_number);
+        break;
+
+      case Lexer::TOKEN_EOF:
+        parse_error("Unexpected EOF.");
+    }
+
+    // a value is complete, update the enclosing list
+    m_token = m_lexer.get_next_token();
+    if (!m_stack.empty())
+    {
+      switch(m_stack.back())
+      {
+        case EMPTY_LIST:
+          m_stack.back() = LIST;
+          break;
+
+        case EMPTY_ARRAY:
+          m_stack.back() = ARRAY;
+          break;
+
+        case DOT:
+          if (m_token != Lexer::TOKEN_CLOSE_PAREN)
+          {
+            parse_error("Expected ')'");
+          }
+          m_stack.back() = DOTTED_LIST;
+          break;
+
+        default:
+          break;
+      }
+    }
+  }
+  while(!m_stack.empty());
+
+  return true;
+}
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
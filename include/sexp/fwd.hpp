@@ -19,6 +19,7 @@
 
 namespace sexp {
 
+class Arena;
 class TypeError;
 class Lexer;
 class Parser;
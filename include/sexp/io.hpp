@@ -19,12 +19,13 @@
 #define HEADER_SEXP_IO_HPP
 
 #include <ostream>
+#include <string_view>
 
 #include <sexp/value.hpp>
 
 namespace sexp {
 
-void escape_string(std::ostream& os, std::string const& text);
+void escape_string(std::ostream& os, std::string_view text);
 
 std::ostream& operator<<(std::ostream& os, Value const& sx);
 
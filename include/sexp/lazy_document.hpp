@@ -0,0 +1,155 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_LAZY_DOCUMENT_HPP
+#define HEADER_SEXP_LAZY_DOCUMENT_HPP
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <sexp/value.hpp>
+
+namespace sexp {
+
+class LazyDocument;
+class MappedFile;
+class StructuralIndex;
+
+/** Handle to a part of a LazyDocument, cheap to copy and only valid as
+    long as the document is. Navigating with get_car() and get_cdr()
+    only looks at the structure of the document, the content is lexed
+    when get() is called. */
+class LazyValue
+{
+public:
+  LazyValue() : m_doc(nullptr), m_idx(0), m_kind(NIL) {}
+
+  bool is_nil() const;
+  bool is_cons() const;
+  bool is_array() const;
+
+  /** Neither a cons nor an array */
+  bool is_atom() const;
+
+  LazyValue get_car() const;
+  LazyValue get_cdr() const;
+
+  /** The Value for this part of the document, built on the first call
+      and kept in the document afterwards */
+  Value const& get() const;
+
+  /** True for a symbol named \a name, doesn't build a Value */
+  bool is_symbol(std::string_view name) const;
+
+private:
+  friend class LazyDocument;
+
+  enum Kind : unsigned char
+  {
+    NIL,
+    ELEMENT,  // the element starting at token m_idx
+    TAIL      // the rest of a list, starting at token m_idx
+  };
+
+  LazyValue(LazyDocument const* doc, uint32_t idx, Kind kind) :
+    m_doc(doc), m_idx(idx), m_kind(kind)
+  {}
+
+  [[noreturn]]
+  void type_error(const char* msg) const;
+
+private:
+  LazyDocument const* m_doc;
+  uint32_t m_idx;
+  Kind m_kind;
+};
+
+/** A document that is only checked for balanced parentheses and
+    terminated strings up front, using the SIMD structural index. The
+    Values for the parts that are actually used are built on demand,
+    they are the same, including line numbers, as those Parser would
+    produce. Errors that are not structural only show up once the
+    broken part is accessed. A LazyDocument is not thread-safe, not
+    even for concurrent reads. */
+class LazyDocument
+{
+public:
+  /** \a text must outlive the document */
+  LazyDocument(std::string_view text, bool use_arrays = false);
+  ~LazyDocument();
+
+  static LazyDocument from_file(std::string const& filename, bool use_arrays = false);
+
+  /** The first top level form */
+  LazyValue get_root() const;
+
+  /** All top level forms as a list */
+  LazyValue get_forms() const;
+
+private:
+  friend class LazyValue;
+
+  struct FileTag {};
+  LazyDocument(FileTag, std::string const& filename, bool use_arrays);
+
+  void build();
+
+  [[noreturn]]
+  void parse_error(size_t offset, const char* msg) const;
+
+  size_t offset(uint32_t idx) const;
+  bool is_open(uint32_t idx) const;
+  bool is_array_start(uint32_t idx) const;
+  bool is_dot(uint32_t idx) const;
+  bool is_end(uint32_t idx) const;
+
+  /** Index of the token following the element starting at \a idx */
+  uint32_t skip(uint32_t idx) const;
+
+  LazyValue make_tail(uint32_t idx) const;
+  Value const& materialize(LazyValue const& value) const;
+  Value parse_element(uint32_t idx) const;
+
+private:
+  std::unique_ptr<MappedFile> m_file;
+  std::string m_storage;
+  std::string_view m_text;
+  bool m_use_arrays;
+
+  std::unique_ptr<StructuralIndex> m_index;
+
+  /** For the token of every '(', the token of the matching ')' */
+  std::vector<uint32_t> m_match;
+
+  mutable std::unordered_map<uint64_t, Value> m_cache;
+
+private:
+  LazyDocument(const LazyDocument&);
+  LazyDocument & operator=(const LazyDocument&);
+};
+
+/** Same as assoc_ref() for Values */
+LazyValue assoc_ref(LazyValue const& sx, std::string_view key);
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
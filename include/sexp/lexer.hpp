@@ -19,9 +19,15 @@
 #define HEADER_SEXP_LEXER_HPP
 
 #include <istream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 namespace sexp {
 
+class StructuralIndex;
+
 class Lexer
 {
 public:
@@ -39,32 +45,98 @@ public:
     TOKEN_ARRAY_START
   };
 
+  /** Size of the reads from a std::istream */
+  static const size_t DEFAULT_BUFFER_SIZE = 16384;
+
 public:
-  Lexer(std::istream& stream, bool use_arrays = false);
+  /** Lex from \a stream, reading \a buffer_size bytes at a time */
+  Lexer(std::istream& stream, bool use_arrays = false, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+  /** Lex directly from an in-memory buffer, the buffer must outlive
+      the Lexer. Tokens returned by get_string_view() point into
+      \a text unless they had to be unescaped. Line numbers start at
+      \a first_line, for when \a text is a piece of a larger input. */
+  Lexer(std::string_view text, bool use_arrays = false, int first_line = 0);
   ~Lexer();
 
+  /** Start over with new input, the buffers allocated so far are
+      kept for reuse */
+  void reset(std::istream& stream);
+  void reset(std::string_view text, int first_line = 0);
+
   TokenType get_next_token();
-  std::string const& get_string() const { return m_token_string; }
-  int get_line_number() const { return m_linenumber; }
+
+  /** The text of the current token, only valid until the next call
+      to get_next_token() */
+  std::string_view get_string_view() const { return m_token_view; }
+  std::string get_string() const { return std::string(m_token_view); }
+
+  /** Newlines are not counted character by character while lexing,
+      but in bulk when the line number is requested */
+  int get_line_number() const
+  {
+    if (m_line_pos != m_bufpos) {
+      count_lines();
+    }
+    return m_linenumber;
+  }
+
+  /** The value of a TOKEN_INTEGER, accumulated while the token was
+      scanned. Throws std::out_of_range when it doesn't fit into an
+      int. */
+  int get_integer() const
+  {
+    if (m_integer_overflow) {
+      throw std::out_of_range("sexp::Lexer::get_integer(): integer out of range");
+    }
+    return m_integer;
+  }
+
+  /** The value of a TOKEN_REAL */
+  float get_real() const;
 
 private:
-  static const int MAX_TOKEN_LENGTH = 16384;
-  static const int BUFFER_SIZE = 16384;
+  /** In-memory input of at least this size is considered for a
+      structural index to skip whitespace and comments */
+  static const size_t STRUCTURAL_INDEX_THRESHOLD = 65536;
 
 private:
+  friend class ParseContext;
+
+  /** Only valid before the buffer was allocated by the first stream */
+  void set_buffer_size(size_t size);
+
   inline void next_char();
   inline void add_char();
+  inline char const* current() const;
+  inline void finish_token(char const* start);
+  inline void skip_blank();
+  void count_lines() const;
 
 private:
-  std::istream& m_stream;
+  std::istream* m_stream;
   bool m_use_arrays;
   bool m_eof;
-  int m_linenumber;
-  char m_buffer[BUFFER_SIZE+1];
+  mutable int m_linenumber;
+
+  /** Newlines before this position are included in m_linenumber */
+  mutable char const* m_line_pos;
+
+  /** Buffer for reading from m_stream, with room for an extra ' ' at
+      the end, only allocated for streams */
+  std::unique_ptr<char[]> m_buffer;
+  size_t m_buffer_size;
   char* m_bufend;
   char* m_bufpos;
   int m_c;
   std::string m_token_string;
+  std::string_view m_token_view;
+  int m_integer;
+  bool m_integer_overflow;
+
+  char const* m_begin;
+  std::unique_ptr<StructuralIndex> m_index;
+  size_t m_index_pos;
 
 private:
   Lexer(const Lexer&);
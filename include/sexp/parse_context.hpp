@@ -0,0 +1,94 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_PARSE_CONTEXT_HPP
+#define HEADER_SEXP_PARSE_CONTEXT_HPP
+
+#include <istream>
+#include <memory_resource>
+#include <stddef.h>
+#include <string_view>
+#include <vector>
+
+#include <sexp/arena.hpp>
+#include <sexp/lexer.hpp>
+#include <sexp/parser.hpp>
+#include <sexp/value.hpp>
+
+namespace sexp {
+
+/** Long lived Lexer and Parser for parsing many small inputs one
+    after another, e.g. messages from a socket. The stream buffer,
+    the token buffer and the Parser's stack are allocated once and
+    reused, where Parser::from_string_view() and friends start from
+    scratch on every call:
+
+      sexp::ParseContext ctx;
+      for(std::string_view message : messages) {
+        sexp::Value value = ctx.from_string_view(message);
+        ...
+      }
+
+    With an Arena or a std::pmr::memory_resource the values are
+    allocated from it, call Arena::clear() once the values of a
+    message are gone to reuse its memory for the next one.
+
+    A ParseContext can still be used after a parse error. It is not
+    thread-safe, use one per thread. */
+class ParseContext
+{
+public:
+  /** \a buffer_size is the size of the reads from a std::istream */
+  ParseContext(bool use_arrays = false, size_t buffer_size = Lexer::DEFAULT_BUFFER_SIZE);
+
+  /** Allocate values from \a arena instead of the heap */
+  ParseContext(Arena& arena, bool use_arrays = false, size_t buffer_size = Lexer::DEFAULT_BUFFER_SIZE);
+
+  /** Allocate values from \a resource instead of the heap */
+  ParseContext(std::pmr::memory_resource& resource, bool use_arrays = false,
+               size_t buffer_size = Lexer::DEFAULT_BUFFER_SIZE);
+  ~ParseContext();
+
+  Value from_string_view(std::string_view str);
+  Value from_stream(std::istream& stream);
+
+  std::vector<Value> from_string_view_many(std::string_view str);
+  std::vector<Value> from_stream_many(std::istream& stream);
+
+  /** See Parser::set_line_numbers() */
+  void set_line_numbers(bool enable) { m_parser.set_line_numbers(enable); }
+
+  /** See Parser::set_typed_arrays() */
+  void set_typed_arrays(bool enable) { m_parser.set_typed_arrays(enable); }
+
+private:
+  /** Read a single value and make sure that nothing follows it */
+  Value read_one();
+
+private:
+  Lexer m_lexer;
+  Parser m_parser;
+
+private:
+  ParseContext(const ParseContext&);
+  ParseContext & operator=(const ParseContext&);
+};
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
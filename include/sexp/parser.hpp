@@ -18,7 +18,12 @@
 #ifndef HEADER_SEXP_PARSER_HPP
 #define HEADER_SEXP_PARSER_HPP
 
+#include <cstddef>
+#include <iterator>
 #include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include <sexp/lexer.hpp>
@@ -26,6 +31,7 @@
 
 namespace sexp {
 
+class FormRange;
 class Lexer;
 
 class Parser
@@ -33,31 +39,239 @@ class Parser
 public:
   enum { USE_ARRAYS = true };
 
+  /** Default limit for the nesting of lists and arrays */
+  static const int DEFAULT_MAX_DEPTH = 1 << 20;
+
   static Value from_string(std::string const& str, bool use_arrays = false);
   static Value from_stream(std::istream& stream, bool use_arrays = false);
 
+  /** Parse directly from \a str without copying it into a stream */
+  static Value from_string_view(std::string_view str, bool use_arrays = false);
+
   static std::vector<Value> from_string_many(std::string const& str, bool use_arrays =  false);
+  static std::vector<Value> from_string_view_many(std::string_view str, bool use_arrays = false);
+
+  /** Parse the content of \a filename, regular files are memory
+      mapped and lexed in place, everything else is read through a
+      std::ifstream */
+  static Value from_file(std::string const& filename, bool use_arrays = false);
+  static std::vector<Value> from_file_many(std::string const& filename, bool use_arrays = false);
   static std::vector<Value> from_stream_many(std::istream& stream, bool use_arrays = false);
 
+  /** Single pass range over the top level forms of \a stream, only
+      the current form is kept in memory:
+
+        for(sexp::Value const& value : sexp::Parser::forms(stream)) { ... }
+  */
+  static FormRange forms(std::istream& stream, bool use_arrays = false);
+  static FormRange forms(std::string_view str, bool use_arrays = false);
+
+  /** Parse the top level forms of \a str on \a num_threads threads,
+      0 uses one thread per core. The input is split at top level form
+      boundaries, the result is the same as from_string_view_many().
+      Small inputs are parsed on the calling thread. */
+  static std::vector<Value> from_string_view_many_parallel(std::string_view str, bool use_arrays = false,
+                                                           unsigned num_threads = 0);
+  static std::vector<Value> from_file_many_parallel(std::string const& filename, bool use_arrays = false,
+                                                    unsigned num_threads = 0);
+
+  /** Variants that allocate the strings, cons cells and arrays of the
+      result from \a arena, the result must not outlive \a arena */
+  static Value from_string(std::string const& str, Arena& arena, bool use_arrays = false);
+  static Value from_string_view(std::string_view str, Arena& arena, bool use_arrays = false);
+  static Value from_stream(std::istream& stream, Arena& arena, bool use_arrays = false);
+  static Value from_file(std::string const& filename, Arena& arena, bool use_arrays = false);
+
+  static std::vector<Value> from_string_many(std::string const& str, Arena& arena, bool use_arrays = false);
+  static std::vector<Value> from_string_view_many(std::string_view str, Arena& arena, bool use_arrays = false);
+  static std::vector<Value> from_stream_many(std::istream& stream, Arena& arena, bool use_arrays = false);
+  static std::vector<Value> from_file_many(std::string const& filename, Arena& arena, bool use_arrays = false);
+
+  /** Variants that allocate the strings, cons cells and arrays of the
+      result from \a resource, see Value::cons() */
+  static Value from_string(std::string const& str, std::pmr::memory_resource& resource, bool use_arrays = false);
+  static Value from_string_view(std::string_view str, std::pmr::memory_resource& resource, bool use_arrays = false);
+  static Value from_stream(std::istream& stream, std::pmr::memory_resource& resource, bool use_arrays = false);
+  static Value from_file(std::string const& filename, std::pmr::memory_resource& resource, bool use_arrays = false);
+
+  static std::vector<Value> from_string_many(std::string const& str, std::pmr::memory_resource& resource,
+                                             bool use_arrays = false);
+  static std::vector<Value> from_string_view_many(std::string_view str, std::pmr::memory_resource& resource,
+                                                  bool use_arrays = false);
+  static std::vector<Value> from_stream_many(std::istream& stream, std::pmr::memory_resource& resource,
+                                             bool use_arrays = false);
+  static std::vector<Value> from_file_many(std::string const& filename, std::pmr::memory_resource& resource,
+                                           bool use_arrays = false);
+
+private:
+  /** Inputs smaller than this are not worth splitting up */
+  static constexpr size_t PARALLEL_THRESHOLD = 1 << 20;
+
+  /** Pieces handed to a thread are at least this large */
+  static constexpr size_t PARALLEL_MIN_CHUNK_SIZE = 256 * 1024;
+
 public:
-  Parser(Lexer& lexer);
+  /** \a max_depth limits the nesting of lists and arrays, deeper
+      input is rejected with a parse error */
+  Parser(Lexer& lexer, int max_depth = DEFAULT_MAX_DEPTH);
+
+  /** Allocate values from \a arena instead of the heap */
+  Parser(Lexer& lexer, Arena& arena, int max_depth = DEFAULT_MAX_DEPTH);
+
+  /** Allocate values from \a resource instead of the heap */
+  Parser(Lexer& lexer, std::pmr::memory_resource& resource, int max_depth = DEFAULT_MAX_DEPTH);
   ~Parser();
 
+  /** Read the next value from the Lexer */
+  Value read();
+
+  /** Read values until the end of the input */
+  std::vector<Value> read_many();
+
+  /** True when the input is exhausted */
+  bool eof() const { return m_token == Lexer::TOKEN_EOF; }
+
+  /** When disabled the values read get line 0 instead of their line
+      number, which saves the Lexer from counting the lines of input
+      that is read without errors. Parse errors still report the
+      correct line. */
+  void set_line_numbers(bool enable) { m_line_numbers = enable; }
+
+  /** When enabled arrays of only integers or only reals are read as
+      INT_ARRAY or REAL_ARRAY, see Value::int_array(). These are not
+      accessible with Value::as_array(), so it is off by default. */
+  void set_typed_arrays(bool enable) { m_typed_arrays = enable; }
+
+  /** Start over after the Lexer was reset() onto new input, a
+      partially read value is dropped */
+  void reset();
+
 private:
+  friend class ParseContext;
+  friend class Reader;
+
+  struct Frame;
+
+  /** Continue reading with \a token, which was already taken from
+      \a lexer */
+  Parser(Lexer& lexer, Lexer::TokenType token);
+
+  /** Where the strings, cons cells and arrays of the result are
+      allocated, the heap when both are nullptr */
+  struct Allocator
+  {
+    Arena* arena;
+    std::pmr::memory_resource* resource;
+  };
+
+  static Value read_one(Lexer& lexer, Allocator alloc);
+  static std::vector<Value> read_all(Lexer& lexer, Allocator alloc);
+  static Value read_file(std::string const& filename, Allocator alloc, bool use_arrays);
+  static std::vector<Value> read_file_many(std::string const& filename, Allocator alloc, bool use_arrays);
+
+  Value make_string(std::string_view text);
+  Value make_cons(Value&& car);
+  Value make_array(std::vector<Value>&& arr);
+
   [[noreturn]]
   void parse_error(const char* msg) const;
-  std::vector<Value> read_many();
-  Value read();
 
 private:
   Lexer& m_lexer;
+  Allocator m_alloc;
   Lexer::TokenType m_token;
+  int m_max_depth;
+  bool m_line_numbers;
+  bool m_typed_arrays;
+
+  /** Lists and arrays that are currently being read, kept around to
+      reuse the allocation between calls to read() */
+  std::vector<Frame> m_stack;
 
 private:
   Parser(const Parser&);
   Parser & operator=(const Parser&);
 };
 
+class FormRange
+{
+public:
+  class iterator
+  {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Value*;
+    using reference = Value&;
+
+    /** Result of post-increment, holds on to the previous form */
+    class proxy
+    {
+    public:
+      Value& operator*() { return m_value; }
+
+    private:
+      friend class iterator;
+      explicit proxy(Value&& value) : m_value(std::move(value)) {}
+
+      Value m_value;
+    };
+
+  public:
+    iterator() : m_range(nullptr) {}
+
+    Value& operator*() const { return m_range->m_value; }
+    Value* operator->() const { return &m_range->m_value; }
+
+    iterator& operator++()
+    {
+      if (!m_range->advance()) {
+        m_range = nullptr;
+      }
+      return *this;
+    }
+
+    proxy operator++(int)
+    {
+      proxy result(std::move(m_range->m_value));
+      ++*this;
+      return result;
+    }
+
+    bool operator==(iterator const& other) const { return m_range == other.m_range; }
+
+  private:
+    friend class FormRange;
+    explicit iterator(FormRange* range) : m_range(range) {}
+
+    FormRange* m_range;
+  };
+
+public:
+  FormRange(std::istream& stream, bool use_arrays = false);
+  FormRange(std::string_view str, bool use_arrays = false);
+  ~FormRange();
+
+  /** Reads the first form, can only be called once */
+  iterator begin();
+  iterator end() { return iterator(); }
+
+private:
+  /** Replace the current form with the next one, false at the end of
+      the input */
+  bool advance();
+
+private:
+  Lexer m_lexer;
+  Parser m_parser;
+  Value m_value;
+
+private:
+  FormRange(const FormRange&);
+  FormRange & operator=(const FormRange&);
+};
+
 } // namespace sexp
 
 #endif
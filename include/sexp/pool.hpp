@@ -0,0 +1,71 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_POOL_HPP
+#define HEADER_SEXP_POOL_HPP
+
+#include <memory>
+#include <stddef.h>
+#include <utility>
+
+namespace sexp {
+
+/** Size class allocator for the cons cells and the string and array
+    headers of heap Values. Every thread keeps free lists of its own
+    and exchanges blocks with a global pool in batches, so allocating
+    and releasing rarely takes a lock. Freed memory is kept for reuse
+    and not given back to the system. Built with
+    -DSEXP_POOL_ALLOCATOR=OFF or with AddressSanitizer this forwards
+    to operator new and delete. All functions are thread-safe. */
+class Pool
+{
+public:
+  /** Larger requests go to operator new */
+  static const size_t MAX_SIZE = 64;
+  static const size_t ALIGNMENT = 16;
+
+  static void* allocate(size_t size);
+  static void deallocate(void* ptr, size_t size);
+
+  template<typename T, typename... Args>
+  static T* create(Args&&... args)
+  {
+    static_assert(alignof(T) <= ALIGNMENT, "alignment not supported by sexp::Pool");
+    void* ptr = allocate(sizeof(T));
+    try
+    {
+      return new (ptr) T(std::forward<Args>(args)...);
+    }
+    catch(...)
+    {
+      deallocate(ptr, sizeof(T));
+      throw;
+    }
+  }
+
+  template<typename T>
+  static void destroy(T* ptr)
+  {
+    std::destroy_at(ptr);
+    deallocate(ptr, sizeof(T));
+  }
+};
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
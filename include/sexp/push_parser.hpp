@@ -0,0 +1,124 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_PUSH_PARSER_HPP
+#define HEADER_SEXP_PUSH_PARSER_HPP
+
+#include <stddef.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sexp/value.hpp>
+
+namespace sexp {
+
+/** Parser for input that arrives in chunks, e.g. from a socket or a
+    decompressor. Chunks can end anywhere, including in the middle of
+    a token, a string or a list, only the unfinished top level form is
+    kept between calls:
+
+      sexp::PushParser parser;
+      parser.feed(data, size);
+      sexp::Value value;
+      while(parser.next(value)) { ... }
+      ...
+      parser.finish();
+
+    The forms are the same as from_string_many() would give for the
+    whole input, including line numbers. Parse errors are thrown from
+    feed() or finish(), the PushParser can't be used afterwards. */
+class PushParser
+{
+public:
+  PushParser(bool use_arrays = false);
+  ~PushParser();
+
+  /** Consume the next chunk of input, top level forms that are
+      complete afterwards are parsed and queued for next() */
+  void feed(char const* data, size_t size);
+  void feed(std::string_view data) { feed(data.data(), data.size()); }
+
+  /** Signal the end of the input, parses a trailing top level atom
+      and throws when the input ends within a form */
+  void finish();
+
+  /** Take the next parsed top level form, returns false when there is
+      none */
+  bool next(Value& value);
+
+  /** Line number of the input that hasn't been parsed yet, after
+      finish() the number of lines in the whole input */
+  int get_line_number() const { return m_line; }
+
+private:
+  enum State : unsigned char
+  {
+    BLANK,
+    ATOM,  // only at the top level
+    STRING,
+    STRING_ESCAPE,
+    STRING_END, // after a top level string
+    COMMENT
+  };
+
+  /** Find the end of the last complete top level form in the input
+      that hasn't been scanned yet */
+  void scan();
+
+  /** Parse and drop the first \a size bytes of m_input */
+  void parse(size_t size);
+
+  /** Drop the first \a size bytes of m_input, counting their lines */
+  void discard(size_t size);
+
+private:
+  bool m_use_arrays;
+
+  /** Input starting at the first unfinished form */
+  std::string m_input;
+
+  /** Line number of the start of m_input */
+  int m_line;
+
+  /** Scanner state at m_scan_pos */
+  size_t m_scan_pos;
+  State m_state;
+  int m_depth;
+
+  /** The current atom consists of a single '#' so far */
+  bool m_hash;
+
+  /** End of the last complete top level form in m_input */
+  size_t m_form_end;
+
+  /** End of the blanks and finished comments that follow the complete
+      top level forms, they are dropped without parsing them */
+  size_t m_blank_end;
+
+  std::vector<Value> m_values;
+  size_t m_next;
+
+private:
+  PushParser(const PushParser&);
+  PushParser & operator=(const PushParser&);
+};
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
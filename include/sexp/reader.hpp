@@ -0,0 +1,137 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_READER_HPP
+#define HEADER_SEXP_READER_HPP
+
+#include <string_view>
+#include <vector>
+
+#include <sexp/lexer.hpp>
+#include <sexp/value.hpp>
+
+namespace sexp {
+
+/** Pull style cursor over the elements of a document. The cursor
+    starts before the first top level element, next() moves it from
+    element to element within the current list, enter() and leave()
+    move it into and out of lists and arrays. Elements that aren't
+    entered or materialized are skipped token by token without
+    allocating. The '.' of dotted lists is skipped, the last element
+    is reported like any other. Skipped input is checked the same way
+    Parser checks it. */
+class Reader
+{
+public:
+  Reader(Lexer& lexer);
+  ~Reader();
+
+  /** Move to the next element of the current list, returns false at
+      the end of the list or, at the top level, the end of input */
+  bool next();
+
+  /** Move before the first element of the current list or array */
+  void enter();
+
+  /** Skip the remaining elements of the current list or array, leave
+      the cursor at its end */
+  void skip();
+
+  /** Skip the remaining elements of the current list or array and
+      move back to it in the enclosing list, next() continues with its
+      sibling */
+  void leave();
+
+  /** Build a Value for the current element, next() continues with
+      its sibling */
+  Value materialize();
+
+  /** Number of lists and arrays entered */
+  int get_depth() const { return static_cast<int>(m_frames.size()); }
+
+  /** Information about the current element */
+  int get_line() const { return m_line; }
+  bool is_list() const { return m_state == ON && m_token == Lexer::TOKEN_OPEN_PAREN; }
+  bool is_array() const { return m_state == ON && m_token == Lexer::TOKEN_ARRAY_START; }
+  bool is_symbol() const { return m_state == ON && m_token == Lexer::TOKEN_SYMBOL; }
+  bool is_string() const { return m_state == ON && m_token == Lexer::TOKEN_STRING; }
+  bool is_integer() const { return m_state == ON && m_token == Lexer::TOKEN_INTEGER; }
+  bool is_real() const { return m_state == ON && (m_token == Lexer::TOKEN_REAL || m_token == Lexer::TOKEN_INTEGER); }
+  bool is_boolean() const { return m_state == ON && (m_token == Lexer::TOKEN_TRUE || m_token == Lexer::TOKEN_FALSE); }
+
+  /** The text of the current symbol or string, only valid until the
+      cursor is moved */
+  std::string_view get_string_view() const;
+  int as_int() const;
+  float as_float() const;
+  bool as_bool() const;
+
+private:
+  enum State
+  {
+    BEFORE,   // before the first element of a list
+    ON,       // on an element, m_token is its first token
+    CONSUMED, // past an element, m_token is the token after it
+    END       // at the end of a list, m_token is ')' or EOF
+  };
+
+  /** What has been seen of an entered or skipped list or array */
+  enum Frame : unsigned char
+  {
+    EMPTY_LIST,  // '(' seen, no element yet
+    LIST,
+    DOT,         // '.' seen, waiting for the last element
+    DOTTED_LIST, // last element seen, waiting for ')'
+    EMPTY_ARRAY, // '#(' seen, no element yet
+    ARRAY
+  };
+
+  void advance();
+  void skip_element();
+
+  /** Open a list or array, m_token is its first token */
+  void push_frame();
+
+  /** Record that an element of the innermost list was finished */
+  void finish_element();
+
+  /** Check m_token against the innermost list and move past a '.' */
+  void check_separator();
+  void require_element(const char* msg) const;
+
+  [[noreturn]]
+  void parse_error(const char* msg) const;
+
+private:
+  Lexer& m_lexer;
+  Lexer::TokenType m_token;
+  int m_line;
+  State m_state;
+
+  /** Entered lists and arrays, followed by the ones that are
+      currently being skipped */
+  std::vector<Frame> m_frames;
+
+private:
+  Reader(const Reader&);
+  Reader & operator=(const Reader&);
+};
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
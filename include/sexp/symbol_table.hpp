@@ -0,0 +1,57 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_SYMBOL_TABLE_HPP
+#define HEADER_SEXP_SYMBOL_TABLE_HPP
+
+#include <string>
+#include <string_view>
+
+namespace sexp {
+
+/** Process wide table of symbol names. Every name is stored once and
+    stays around until the program exits, so two symbols in the table
+    are equal exactly when they point to the same string. The table
+    stops growing at get_max_size() names, so input full of distinct
+    symbols can't use up memory, Values keep their own copy of names
+    that don't fit. All functions are thread-safe. */
+class SymbolTable
+{
+public:
+  static const size_t DEFAULT_MAX_SIZE = 64 * 1024;
+
+  /** The unique string for \a name, adding it if necessary. Returns
+      nullptr when \a name is new and the table is full. */
+  static std::string const* intern(std::string_view name);
+
+  /** The unique string for \a name, nullptr if \a name was never
+      interned and thus no symbol with that name exists */
+  static std::string const* find(std::string_view name);
+
+  /** Number of interned names */
+  static size_t size();
+
+  /** Limit the number of names, names that are already in the table
+      stay there */
+  static void set_max_size(size_t max_size);
+  static size_t get_max_size();
+};
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
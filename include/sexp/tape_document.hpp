@@ -0,0 +1,460 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_TAPE_DOCUMENT_HPP
+#define HEADER_SEXP_TAPE_DOCUMENT_HPP
+
+#include <istream>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sexp/value.hpp>
+
+namespace sexp {
+
+class TapeDocument;
+
+/** Read-only view of a part of a TapeDocument, cheap to copy and only
+    valid as long as the document is. Supports the same navigation as
+    a const Value. */
+class NodeRef
+{
+public:
+  NodeRef() : m_doc(nullptr), m_idx(0), m_list(NO_LIST) {}
+
+  inline Value::Type get_type() const;
+
+  explicit operator bool() const { return !is_nil(); }
+
+  bool is_nil() const { return get_type() == Value::Type::NIL; }
+  bool is_boolean() const { return get_type() == Value::Type::BOOLEAN; }
+  bool is_integer() const { return get_type() == Value::Type::INTEGER; }
+  bool is_real() const { return get_type() == Value::Type::REAL || get_type() == Value::Type::INTEGER; }
+  bool is_string() const { return get_type() == Value::Type::STRING; }
+  bool is_symbol() const { return get_type() == Value::Type::SYMBOL; }
+  bool is_cons() const { return m_list != NO_LIST; }
+  bool is_array() const { return get_type() == Value::Type::ARRAY; }
+
+  /** The line of the element, for the rest of a list the line of its
+      first element */
+  int get_line() const;
+
+  inline NodeRef get_car() const;
+  inline NodeRef get_cdr() const;
+
+  bool as_bool() const;
+  inline int as_int() const;
+  float as_float() const;
+  std::string_view as_string_view() const;
+
+  int get_array_size() const;
+  /** Walks over the preceding elements, use NodeListAdapter for
+      iterating */
+  NodeRef array_ref(int index) const;
+
+  /** True for a symbol named \a name */
+  bool is_symbol(std::string_view name) const;
+
+  /** Builds a Value for this part of the document */
+  Value to_value() const;
+
+private:
+  friend class TapeDocument;
+  friend class NodeListIterator;
+  friend class NodeTreeIterator;
+
+  static constexpr uint32_t NO_LIST = UINT32_MAX;
+
+  /** An element when \a list is NO_LIST, otherwise the rest of the
+      list starting at node \a list, beginning with node \a idx */
+  NodeRef(TapeDocument const* doc, uint32_t idx, uint32_t list) :
+    m_doc(doc), m_idx(idx), m_list(list)
+  {}
+
+  [[noreturn]]
+  void type_error(const char* msg) const;
+
+private:
+  TapeDocument const* m_doc;
+  uint32_t m_idx;
+  uint32_t m_list;
+};
+
+/** A document that is frozen after construction with all nodes laid
+    out in one array in depth-first order and the characters of
+    strings and symbols in a separate pool, so walking over it touches
+    memory sequentially instead of following pointers. Lists are
+    stored as a single node followed by their elements, "()" becomes
+    nil as in Value. The document is limited to 4G nodes and 4GB of
+    string data, concurrent reads are fine. */
+class TapeDocument
+{
+public:
+  static TapeDocument from_string_view(std::string_view str, bool use_arrays = false);
+  static TapeDocument from_stream(std::istream& stream, bool use_arrays = false);
+  static TapeDocument from_file(std::string const& filename, bool use_arrays = false);
+
+  /** Copies \a value, which becomes the only top level form */
+  static TapeDocument from_value(Value const& value);
+
+  TapeDocument(TapeDocument&&) = default;
+  TapeDocument& operator=(TapeDocument&&) = default;
+
+  /** The first top level form */
+  NodeRef get_root() const;
+
+  /** All top level forms as a list */
+  NodeRef get_forms() const;
+
+  /** Number of nodes, the list of top level forms included */
+  size_t size() const { return m_nodes.size(); }
+
+private:
+  friend class NodeRef;
+  friend class NodeListIterator;
+  friend class NodeTreeIterator;
+  class Builder;
+
+  enum Flags : unsigned char
+  {
+    DOTTED = 1  // the last element of the list is its cdr
+  };
+
+  struct Node
+  {
+    Value::Type type;
+    unsigned char flags;
+
+    /** Number of nodes in the subtree including this one, so the
+        next sibling is at index + next */
+    uint32_t next;
+
+    /** Elements of a list or array, not counting the cdr of a dotted
+        list, or the size of a string or symbol */
+    uint32_t length;
+
+    union
+    {
+      bool boolean;
+      int integer;
+      float real;
+      uint32_t offset;  // into m_strings
+    };
+  };
+
+  TapeDocument();
+
+  inline NodeRef make_element(uint32_t idx) const;
+  inline NodeRef make_rest(uint32_t idx, uint32_t list) const;
+
+private:
+  std::vector<Node> m_nodes;
+
+  /** Kept apart from m_nodes as scans rarely need them */
+  std::vector<int> m_lines;
+
+  std::string m_strings;
+
+private:
+  TapeDocument(const TapeDocument&);
+  TapeDocument & operator=(const TapeDocument&);
+};
+
+/** Iterates over the elements of a list like ListIterator, and also
+    over the elements of an array */
+class NodeListIterator
+{
+public:
+  NodeListIterator() : m_doc(nullptr), m_idx(0), m_end(0), m_dotted(false) {}
+  inline explicit NodeListIterator(NodeRef const& sx);
+
+  bool operator==(NodeListIterator const& rhs) const { return m_doc == rhs.m_doc && m_idx == rhs.m_idx; }
+  bool operator!=(NodeListIterator const& rhs) const { return !(*this == rhs); }
+
+  inline NodeRef operator*() const;
+
+  inline NodeListIterator& operator++();
+
+  NodeListIterator operator++(int)
+  {
+    NodeListIterator tmp = *this;
+    operator++();
+    return tmp;
+  }
+
+private:
+  TapeDocument const* m_doc;
+  uint32_t m_idx;
+  uint32_t m_end;
+  bool m_dotted;
+};
+
+class NodeListAdapter
+{
+private:
+  NodeRef m_sx;
+
+public:
+  NodeListAdapter(NodeRef const& sx) :
+    m_sx(sx)
+  {}
+
+  NodeListIterator begin() const { return NodeListIterator(m_sx); }
+  NodeListIterator end() const { return NodeListIterator(); }
+};
+
+/** Visits \a sx and everything below it in depth-first order, a list
+    comes before its elements. As this is the order of the nodes in
+    the document it is a plain sequential scan, the fastest way to
+    look at a whole tree. For the rest of a list the remaining
+    elements and everything below them are visited. */
+class NodeTreeIterator
+{
+public:
+  NodeTreeIterator() : m_doc(nullptr), m_idx(0), m_end(0) {}
+  inline explicit NodeTreeIterator(NodeRef const& sx);
+
+  bool operator==(NodeTreeIterator const& rhs) const { return m_doc == rhs.m_doc && m_idx == rhs.m_idx; }
+  bool operator!=(NodeTreeIterator const& rhs) const { return !(*this == rhs); }
+
+  inline NodeRef operator*() const;
+
+  inline NodeTreeIterator& operator++();
+
+  NodeTreeIterator operator++(int)
+  {
+    NodeTreeIterator tmp = *this;
+    operator++();
+    return tmp;
+  }
+
+private:
+  TapeDocument const* m_doc;
+  uint32_t m_idx;
+  uint32_t m_end;
+};
+
+class NodeTreeAdapter
+{
+private:
+  NodeRef m_sx;
+
+public:
+  NodeTreeAdapter(NodeRef const& sx) :
+    m_sx(sx)
+  {}
+
+  NodeTreeIterator begin() const { return NodeTreeIterator(m_sx); }
+  NodeTreeIterator end() const { return NodeTreeIterator(); }
+};
+
+inline NodeRef car(NodeRef const& sx) { return sx.get_car(); }
+inline NodeRef cdr(NodeRef const& sx) { return sx.get_cdr(); }
+inline NodeRef caar(NodeRef const& sx) { return sx.get_car().get_car(); }
+inline NodeRef cadr(NodeRef const& sx) { return sx.get_car().get_cdr(); }
+inline NodeRef cdar(NodeRef const& sx) { return sx.get_cdr().get_car(); }
+inline NodeRef cddr(NodeRef const& sx) { return sx.get_cdr().get_cdr(); }
+
+/** Same as the functions in util.hpp for Values */
+int list_length(NodeRef const& sx);
+NodeRef list_ref(NodeRef const& sx, int index);
+bool is_list(NodeRef const& sx);
+NodeRef assoc_ref(NodeRef const& sx, std::string_view key);
+
+inline NodeRef
+TapeDocument::make_element(uint32_t idx) const
+{
+  if (m_nodes[idx].type == Value::Type::CONS)
+  {
+    return NodeRef(this, idx + 1, idx);
+  }
+  else
+  {
+    return NodeRef(this, idx, NodeRef::NO_LIST);
+  }
+}
+
+inline NodeRef
+TapeDocument::make_rest(uint32_t idx, uint32_t list) const
+{
+  uint32_t const end = list + m_nodes[list].next;
+  if (idx == end)
+  {
+    return NodeRef();
+  }
+  else if ((m_nodes[list].flags & DOTTED) && idx + m_nodes[idx].next == end)
+  {
+    return make_element(idx);
+  }
+  else
+  {
+    return NodeRef(this, idx, list);
+  }
+}
+
+inline Value::Type
+NodeRef::get_type() const
+{
+  if (!m_doc)
+  {
+    return Value::Type::NIL;
+  }
+  else if (m_list != NO_LIST)
+  {
+    return Value::Type::CONS;
+  }
+  else
+  {
+    return m_doc->m_nodes[m_idx].type;
+  }
+}
+
+inline NodeRef
+NodeRef::get_car() const
+{
+  if (!is_cons())
+  {
+    type_error("sexp::NodeRef::get_car(): wrong type, expected Type::CONS");
+  }
+  return m_doc->make_element(m_idx);
+}
+
+inline NodeRef
+NodeRef::get_cdr() const
+{
+  if (!is_cons())
+  {
+    type_error("sexp::NodeRef::get_cdr(): wrong type, expected Type::CONS");
+  }
+  return m_doc->make_rest(m_idx + m_doc->m_nodes[m_idx].next, m_list);
+}
+
+inline int
+NodeRef::as_int() const
+{
+  if (!is_integer())
+  {
+    type_error("sexp::NodeRef::as_int(): wrong type, expected Type::INTEGER");
+  }
+  return m_doc->m_nodes[m_idx].integer;
+}
+
+inline
+NodeListIterator::NodeListIterator(NodeRef const& sx) :
+  m_doc(nullptr),
+  m_idx(0),
+  m_end(0),
+  m_dotted(false)
+{
+  if (sx.is_cons())
+  {
+    m_doc = sx.m_doc;
+    m_idx = sx.m_idx;
+    m_end = sx.m_list + m_doc->m_nodes[sx.m_list].next;
+    m_dotted = (m_doc->m_nodes[sx.m_list].flags & TapeDocument::DOTTED) != 0;
+  }
+  else if (sx.is_array() && sx.m_doc->m_nodes[sx.m_idx].length != 0)
+  {
+    m_doc = sx.m_doc;
+    m_idx = sx.m_idx + 1;
+    m_end = sx.m_idx + m_doc->m_nodes[sx.m_idx].next;
+  }
+}
+
+inline NodeRef
+NodeListIterator::operator*() const
+{
+  return m_doc->make_element(m_idx);
+}
+
+inline NodeListIterator&
+NodeListIterator::operator++()
+{
+  if (m_doc)
+  {
+    m_idx += m_doc->m_nodes[m_idx].next;
+    // like ListIterator, a cdr that is a list is followed and any
+    // other cdr of a dotted list is left out
+    while(m_dotted && m_idx + m_doc->m_nodes[m_idx].next == m_end &&
+          m_doc->m_nodes[m_idx].type == Value::Type::CONS)
+    {
+      m_end = m_idx + m_doc->m_nodes[m_idx].next;
+      m_dotted = (m_doc->m_nodes[m_idx].flags & TapeDocument::DOTTED) != 0;
+      m_idx += 1;
+    }
+
+    if (m_idx == m_end ||
+        (m_dotted && m_idx + m_doc->m_nodes[m_idx].next == m_end))
+    {
+      *this = NodeListIterator();
+    }
+  }
+  return *this;
+}
+
+inline
+NodeTreeIterator::NodeTreeIterator(NodeRef const& sx) :
+  m_doc(sx.m_doc),
+  m_idx(sx.m_idx),
+  m_end(0)
+{
+  if (!sx.is_cons())
+  {
+    m_end = m_idx + (m_doc ? m_doc->m_nodes[m_idx].next : 0);
+  }
+  else
+  {
+    m_end = sx.m_list + m_doc->m_nodes[sx.m_list].next;
+    if (m_idx == sx.m_list + 1)
+    {
+      // the whole list, not just its elements
+      m_idx = sx.m_list;
+    }
+  }
+
+  if (m_idx == m_end)
+  {
+    *this = NodeTreeIterator();
+  }
+}
+
+inline NodeRef
+NodeTreeIterator::operator*() const
+{
+  return m_doc->make_element(m_idx);
+}
+
+inline NodeTreeIterator&
+NodeTreeIterator::operator++()
+{
+  if (m_doc)
+  {
+    m_idx += 1;
+    if (m_idx == m_end)
+    {
+      *this = NodeTreeIterator();
+    }
+  }
+  return *this;
+}
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
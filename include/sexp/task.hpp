@@ -0,0 +1,142 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_TASK_HPP
+#define HEADER_SEXP_TASK_HPP
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace sexp {
+
+/** Minimal lazily started coroutine returning a \a T. A Task is
+    co_awaited from another coroutine, which is resumed once the
+    result is available, or started with start() from code outside of
+    a coroutine, in which case whoever resumes it last has to check
+    done() before taking the result with get(). */
+template<typename T>
+class Task
+{
+public:
+  class promise_type
+  {
+  public:
+    promise_type() : m_value(), m_exception(), m_continuation() {}
+
+    Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    auto final_suspend() noexcept
+    {
+      struct FinalAwaiter
+      {
+        bool await_ready() noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+        {
+          std::coroutine_handle<> const continuation = handle.promise().m_continuation;
+          return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+      };
+      return FinalAwaiter{};
+    }
+
+    template<typename U>
+    void return_value(U&& value) { m_value.emplace(std::forward<U>(value)); }
+    void unhandled_exception() { m_exception = std::current_exception(); }
+
+    T result()
+    {
+      if (m_exception) {
+        std::rethrow_exception(m_exception);
+      }
+      return std::move(*m_value);
+    }
+
+  private:
+    friend class Task;
+
+    std::optional<T> m_value;
+    std::exception_ptr m_exception;
+    std::coroutine_handle<> m_continuation;
+  };
+
+public:
+  Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+  Task& operator=(Task&& other) noexcept
+  {
+    if (this != &other)
+    {
+      if (m_handle) {
+        m_handle.destroy();
+      }
+      m_handle = std::exchange(other.m_handle, nullptr);
+    }
+    return *this;
+  }
+
+  ~Task()
+  {
+    if (m_handle) {
+      m_handle.destroy();
+    }
+  }
+
+  auto operator co_await() noexcept
+  {
+    struct Awaiter
+    {
+      std::coroutine_handle<promise_type> handle;
+
+      bool await_ready() noexcept { return false; }
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+      {
+        handle.promise().m_continuation = continuation;
+        return handle;
+      }
+      T await_resume() { return handle.promise().result(); }
+    };
+    return Awaiter{m_handle};
+  }
+
+  /** Run the coroutine until it completes or suspends for the first
+      time */
+  void start() { m_handle.resume(); }
+
+  bool done() const { return m_handle.done(); }
+
+  /** The result of a completed Task, rethrows the exception it
+      exited with */
+  T get() { return m_handle.promise().result(); }
+
+private:
+  explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+private:
+  std::coroutine_handle<promise_type> m_handle;
+
+private:
+  Task(const Task&);
+  Task & operator=(const Task&);
+};
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
@@ -19,10 +19,19 @@
 #define HEADER_SEXP_VALUE_HPP
 
 #include <assert.h>
+#include <atomic>
+#include <bit>
 #include <memory>
+#include <memory_resource>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
+#include <sexp/arena.hpp>
 #include <sexp/error.hpp>
+#include <sexp/pool.hpp>
+#include <sexp/symbol_table.hpp>
 #include <stdint.h>
 
 namespace sexp {
@@ -39,39 +48,204 @@ public:
     STRING,
     SYMBOL,
     CONS,
-    ARRAY
+    ARRAY,
+    INT_ARRAY,
+    REAL_ARRAY
   };
 
 private:
   struct Cons;
+  struct ResourceCons;
+
+  /** Long strings of heap Values and symbols that don't fit into the
+      SymbolTable */
+  using String = std::string;
+
+  /** Long strings and arrays of arena Values, their payload comes
+      from the same memory_resource as the Value itself. Arrays use
+      them for heap Values as well, with the default resource. */
+  using ArenaString = std::pmr::string;
+  using Array = std::pmr::vector<Value>;
+  using IntArray = std::pmr::vector<int>;
+  using RealArray = std::pmr::vector<float>;
+
+  /** Who owns the memory of a string, symbol, cons cell or array.
+      ARENA memory belongs to an Arena or a std::pmr::memory_resource,
+      INLINE strings are stored in the Value itself and INLINE symbols
+      in the SymbolTable, SHARED ones are reference counted. Symbols
+      that don't fit into the SymbolTable own a String like long
+      strings do. Cons cells are never inline, for them the same bits
+      mark a ResourceCons. */
+  enum Storage : unsigned char
+  {
+    HEAP,
+    ARENA,
+    INLINE,
+    SHARED,
+    RESOURCE = INLINE
+  };
 
-#if INTPTR_MAX == INT32_MAX
-  unsigned m_line : 24;
+  /** A string, cons cell or array together with its reference count */
+  template<typename T>
+  struct Shared : public T
+  {
+    explicit Shared(T&& value) : T(std::move(value)), refs(1) {}
+    std::atomic<unsigned> refs;
+  };
+
+#ifdef SEXP_COMPACT_VALUE
+  static_assert(sizeof(void*) == 8, "SEXP_COMPACT_VALUE requires a 64-bit system");
+
+  /** Bits 0-3 hold the type and bits 4-5 the storage. Booleans,
+      integers, reals and inline strings keep their value in the upper
+      32 bits, the inline string size in bits 6-8 and the line in bits
+      9-31. Everything else keeps a pointer in bits 6-49, which relies
+      on 8 byte alignment and user space addresses being below 2^47,
+      and the line in bits 50-63. Lines that don't fit are stored as
+      the largest one that does, 16383 for those, so they can't be
+      mistaken for line 0. */
+  uint64_t m_bits;
+
+  static constexpr size_t INLINE_CAPACITY = 4;
+  static constexpr size_t INLINE_OFFSET = (std::endian::native == std::endian::little) ? 4 : 0;
+  static constexpr uint64_t POINTER_MASK = ((uint64_t(1) << 44) - 1) << 6;
+  static constexpr int POINTER_LINE_SHIFT = 50;
+  static constexpr int LINE_SHIFT = 9;
+  static constexpr int LINE_BITS = 23;
+
+  inline Type type() const { return static_cast<Type>(m_bits & 0xf); }
+  inline unsigned storage() const { return (m_bits >> 4) & 0x3; }
+  inline bool has_pointer() const
+  {
+    return type() >= Type::STRING && (m_bits & 0x3f) != ((uint64_t(INLINE) << 4) | static_cast<uint64_t>(Type::STRING));
+  }
+  inline uint32_t payload() const { return static_cast<uint32_t>(m_bits >> 32); }
+  template<typename T>
+  inline T* pointer() const { return reinterpret_cast<T*>((m_bits & POINTER_MASK) >> 3); }
+
+  inline bool bool_value() const { return payload() != 0; }
+  inline int int_value() const { return static_cast<int>(payload()); }
+  inline float float_value() const { return std::bit_cast<float>(payload()); }
+  inline String* string_ptr() const { return pointer<String>(); }
+  inline ArenaString* arena_string_ptr() const { return pointer<ArenaString>(); }
+  inline std::string const* symbol_ptr() const { return pointer<std::string const>(); }
+  inline Cons* cons_ptr() const { return pointer<Cons>(); }
+  inline Array* array_ptr() const { return pointer<Array>(); }
+  inline IntArray* int_array_ptr() const { return pointer<IntArray>(); }
+  inline RealArray* real_array_ptr() const { return pointer<RealArray>(); }
+  inline std::string_view short_view() const
+  {
+    return std::string_view(reinterpret_cast<char const*>(&m_bits) + INLINE_OFFSET, (m_bits >> 6) & 0x7);
+  }
+
+  inline void set_nil() { m_bits = 0; }
+  inline void set_immediate(Type type, uint32_t value)
+  {
+    m_bits = (uint64_t(value) << 32) | static_cast<uint64_t>(type);
+  }
+  inline void set_bool(bool v) { set_immediate(Type::BOOLEAN, v ? 1 : 0); }
+  inline void set_int(int v) { set_immediate(Type::INTEGER, static_cast<uint32_t>(v)); }
+  inline void set_float(float v) { set_immediate(Type::REAL, std::bit_cast<uint32_t>(v)); }
+  inline void set_pointer(Type type, unsigned storage, void const* ptr)
+  {
+    uint64_t const bits = reinterpret_cast<uintptr_t>(ptr);
+    assert(((bits << 3) & ~POINTER_MASK) == 0);
+    m_bits = (bits << 3) | (uint64_t(storage) << 4) | static_cast<uint64_t>(type);
+  }
+  inline void set_string(String* v, unsigned storage) { set_pointer(Type::STRING, storage, v); }
+  inline void set_string(ArenaString* v) { set_pointer(Type::STRING, ARENA, v); }
+  inline void set_symbol(std::string const* v) { set_pointer(Type::SYMBOL, INLINE, v); }
+  inline void set_symbol(String* v, unsigned storage) { set_pointer(Type::SYMBOL, storage, v); }
+  inline void set_cons(Cons* v, unsigned storage) { set_pointer(Type::CONS, storage, v); }
+  inline void set_array(Array* v, unsigned storage) { set_pointer(Type::ARRAY, storage, v); }
+  inline void set_int_array(IntArray* v, unsigned storage) { set_pointer(Type::INT_ARRAY, storage, v); }
+  inline void set_real_array(RealArray* v, unsigned storage) { set_pointer(Type::REAL_ARRAY, storage, v); }
+  inline void set_short(std::string_view v)
+  {
+    m_bits = (uint64_t(v.size()) << 6) | (uint64_t(INLINE) << 4) | static_cast<uint64_t>(Type::STRING);
+    v.copy(reinterpret_cast<char*>(&m_bits) + INLINE_OFFSET, v.size());
+  }
+  inline void assign(Value const& other) { m_bits = other.m_bits; }
 #else
+#  if INTPTR_MAX == INT32_MAX
+  unsigned m_line : 24;
+  unsigned m_storage : 2;
+  Value::Type m_type : 4;
+#  else
   int m_line;
-#endif
-
+  unsigned char m_storage;
   Value::Type m_type;
+#  endif
 
-  union Data
+  /** Short strings, the last byte holds the length */
+  struct ShortString
   {
-    inline Data() {}
-    inline Data(bool v) : m_bool(v) {}
-    inline Data(int v) : m_int(v) {}
-    inline Data(float v) : m_float(v) {}
-    inline Data(std::string* v) : m_string(v) {}
-    inline Data(Cons* v) : m_cons(v) {}
-    inline Data(std::vector<Value>* v) : m_array(v) {}
+    char chars[sizeof(void*) - 1];
+    unsigned char size;
+  };
 
+  union Data
+  {
     bool m_bool;
     int m_int;
     float m_float;
 
-    std::string* m_string;
+    String* m_string;
+    ArenaString* m_arena_string;
+    std::string const* m_symbol;
     Cons* m_cons;
-    std::vector<Value>* m_array;
+    Array* m_array;
+    IntArray* m_int_array;
+    RealArray* m_real_array;
+    ShortString m_short;
   } m_data;
 
+  static constexpr size_t INLINE_CAPACITY = sizeof(ShortString::chars);
+
+  inline Type type() const { return m_type; }
+  inline unsigned storage() const { return m_storage; }
+
+  inline bool bool_value() const { return m_data.m_bool; }
+  inline int int_value() const { return m_data.m_int; }
+  inline float float_value() const { return m_data.m_float; }
+  inline String* string_ptr() const { return m_data.m_string; }
+  inline ArenaString* arena_string_ptr() const { return m_data.m_arena_string; }
+  inline std::string const* symbol_ptr() const { return m_data.m_symbol; }
+  inline Cons* cons_ptr() const { return m_data.m_cons; }
+  inline Array* array_ptr() const { return m_data.m_array; }
+  inline IntArray* int_array_ptr() const { return m_data.m_int_array; }
+  inline RealArray* real_array_ptr() const { return m_data.m_real_array; }
+  inline std::string_view short_view() const { return std::string_view(m_data.m_short.chars, m_data.m_short.size); }
+
+  inline void set_nil() { m_type = Type::NIL; }
+  inline void set_bool(bool v) { m_storage = HEAP; m_type = Type::BOOLEAN; m_data.m_bool = v; }
+  inline void set_int(int v) { m_storage = HEAP; m_type = Type::INTEGER; m_data.m_int = v; }
+  inline void set_float(float v) { m_storage = HEAP; m_type = Type::REAL; m_data.m_float = v; }
+  inline void set_string(String* v, unsigned storage) { m_storage = storage & 0x3; m_type = Type::STRING; m_data.m_string = v; }
+  inline void set_string(ArenaString* v) { m_storage = ARENA; m_type = Type::STRING; m_data.m_arena_string = v; }
+  inline void set_symbol(std::string const* v) { m_storage = INLINE; m_type = Type::SYMBOL; m_data.m_symbol = v; }
+  inline void set_symbol(String* v, unsigned storage) { m_storage = storage & 0x3; m_type = Type::SYMBOL; m_data.m_string = v; }
+  inline void set_cons(Cons* v, unsigned storage) { m_storage = storage & 0x3; m_type = Type::CONS; m_data.m_cons = v; }
+  inline void set_array(Array* v, unsigned storage) { m_storage = storage & 0x3; m_type = Type::ARRAY; m_data.m_array = v; }
+  inline void set_int_array(IntArray* v, unsigned storage) { m_storage = storage & 0x3; m_type = Type::INT_ARRAY; m_data.m_int_array = v; }
+  inline void set_real_array(RealArray* v, unsigned storage) { m_storage = storage & 0x3; m_type = Type::REAL_ARRAY; m_data.m_real_array = v; }
+  inline void set_short(std::string_view v)
+  {
+    m_storage = INLINE;
+    m_type = Type::STRING;
+    m_data.m_short = ShortString{};
+    v.copy(m_data.m_short.chars, v.size());
+    m_data.m_short.size = static_cast<unsigned char>(v.size());
+  }
+  inline void assign(Value const& other)
+  {
+    m_line = other.m_line;
+    m_storage = other.m_storage;
+    m_type = other.m_type;
+    m_data = other.m_data;
+  }
+#endif
+
   struct BooleanTag {};
   struct IntegerTag {};
   struct RealTag {};
@@ -79,6 +253,8 @@ private:
   struct SymbolTag {};
   struct ConsTag {};
   struct ArrayTag {};
+  struct IntArrayTag {};
+  struct RealArrayTag {};
 
 public:
   /** Returns a reference to a nil value for use in functions that
@@ -88,15 +264,44 @@ public:
   static Value boolean(bool v) { return Value(BooleanTag(), v); }
   static Value integer(int v) { return Value(IntegerTag(), v); }
   static Value real(float v) { return Value(RealTag(), v); }
-  static Value string(std::string const& v) { return Value(StringTag(), v); }
-  static Value symbol(std::string const& v) { return Value(SymbolTag(), v); }
+  static Value string(std::string_view v) { return Value(StringTag(), v); }
+  static Value symbol(std::string_view v) { return Value(SymbolTag(), v); }
   static Value cons(Value&& car, Value&& cdr) { return Value(ConsTag(), std::move(car), std::move(cdr)); }
   static Value cons() { return Value(ConsTag(), Value::nil(), Value::nil()); }
 
   static Value array(std::vector<Value> arr) { return Value(ArrayTag(), std::move(arr)); }
   template<typename... Args>
+    requires (std::is_convertible_v<Args&&, Value> && ...)
   static Value array(Args&&... args) { return Value(ArrayTag(), std::move(args)...); }
 
+  /** Arrays of only integers or only reals stored as plain numbers,
+      a quarter of the size of an array of Values. Parser produces
+      them with Parser::set_typed_arrays() for every non-empty array
+      that consists of just one of the two. They are equal to generic
+      arrays of the same numbers. */
+  static Value int_array(std::vector<int> arr) { return Value(IntArrayTag(), std::move(arr)); }
+  static Value real_array(std::vector<float> arr) { return Value(RealArrayTag(), std::move(arr)); }
+
+  /** Variants that place the string, cons cell or array in \a arena
+      along with their characters and elements, the Value must not
+      outlive \a arena. Symbols are interned and never take memory
+      from \a arena. */
+  static Value string(std::string_view v, Arena& arena) { return Value(StringTag(), v, &arena); }
+  static Value symbol(std::string_view v, Arena&) { return Value(SymbolTag(), v); }
+  static Value cons(Value&& car, Value&& cdr, Arena& arena) { return Value(ConsTag(), std::move(car), std::move(cdr), &arena); }
+  static Value array(std::vector<Value> arr, Arena& arena) { return Value(ArrayTag(), std::move(arr), &arena); }
+  static Value int_array(std::vector<int> arr, Arena& arena) { return Value(IntArrayTag(), std::move(arr), &arena); }
+  static Value real_array(std::vector<float> arr, Arena& arena) { return Value(RealArrayTag(), std::move(arr), &arena); }
+
+  /** Variants that allocate from \a resource, destroying the Value
+      gives the memory back with deallocate(). The Value must not
+      outlive \a resource. */
+  static Value string(std::string_view v, std::pmr::memory_resource& resource) { return Value(StringTag(), v, &resource); }
+  static Value cons(Value&& car, Value&& cdr, std::pmr::memory_resource& resource) { return Value(ConsTag(), std::move(car), std::move(cdr), &resource); }
+  static Value array(std::vector<Value> arr, std::pmr::memory_resource& resource) { return Value(ArrayTag(), std::move(arr), &resource); }
+  static Value int_array(std::vector<int> arr, std::pmr::memory_resource& resource) { return Value(IntArrayTag(), std::move(arr), &resource); }
+  static Value real_array(std::vector<float> arr, std::pmr::memory_resource& resource) { return Value(RealArrayTag(), std::move(arr), &resource); }
+
   static Value list()
   {
     return Value::nil();
@@ -108,83 +313,252 @@ public:
     return Value::cons(std::move(head), list(std::move(rest)...));
   }
 
+#ifdef SEXP_COMPACT_VALUE
+  int get_line() const
+  {
+    return static_cast<int>(has_pointer() ?
+                            m_bits >> POINTER_LINE_SHIFT :
+                            (m_bits >> LINE_SHIFT) & ((uint64_t(1) << LINE_BITS) - 1));
+  }
+  void set_line(int line)
+  {
+    int const shift = has_pointer() ? POINTER_LINE_SHIFT : LINE_SHIFT;
+    int const bits = has_pointer() ? 64 - POINTER_LINE_SHIFT : LINE_BITS;
+    uint64_t const max_line = (uint64_t(1) << bits) - 1;
+    m_bits &= ~(max_line << shift);
+    if (line > 0) {
+      m_bits |= (uint64_t(line) < max_line ? uint64_t(line) : max_line) << shift;
+    }
+  }
+#else
   int get_line() const { return static_cast<int>(m_line); }
   void set_line(int line)
   {
-#if INTPTR_MAX == INT32_MAX
+#  if INTPTR_MAX == INT32_MAX
     m_line = static_cast<unsigned int>(line) & 0xffffff;
-#else
+#  else
     m_line = line;
-#endif
+#  endif
   }
+#endif
 
 private:
-  inline explicit Value(BooleanTag, bool value) : m_line(0), m_type(Type::BOOLEAN), m_data(value) {}
-  inline explicit Value(IntegerTag, int value) : m_line(0), m_type(Type::INTEGER), m_data(value) {}
-  inline explicit Value(RealTag, float value) : m_line(0), m_type(Type::REAL), m_data(value) {}
-  inline Value(StringTag, std::string const& value) :
-    m_line(0),
-    m_type(Type::STRING),
-    m_data(new std::string(value))
-  {}
-  inline Value(SymbolTag, std::string const& value) :
-    m_line(0),
-    m_type(Type::SYMBOL),
-    m_data(new std::string(value))
-  {}
-  inline Value(ConsTag, Value&& car, Value&& cdr);
-  inline Value(ArrayTag, std::vector<Value> arr) :
-    m_line(0),
-    m_type(Type::ARRAY),
-    m_data(new std::vector<Value>(std::move(arr)))
-  {}
+  inline explicit Value(BooleanTag, bool value) : Value() { set_bool(value); }
+  inline explicit Value(IntegerTag, int value) : Value() { set_int(value); }
+  inline explicit Value(RealTag, float value) : Value() { set_float(value); }
+  template<typename Source = Arena>
+  inline Value(StringTag, std::string_view value, Source* source = nullptr) :
+    Value()
+  {
+    if (value.size() <= INLINE_CAPACITY) {
+      set_short(value);
+    } else if (source) {
+      set_string(create<ArenaString>(source, value, resource(source)));
+    } else {
+      set_string(Pool::create<String>(value), HEAP);
+    }
+  }
+  inline Value(SymbolTag, std::string_view value) :
+    Value()
+  {
+    if (std::string const* name = SymbolTable::intern(value)) {
+      set_symbol(name);
+    } else {
+      set_symbol(Pool::create<String>(value), HEAP);
+    }
+  }
+  template<typename Source = Arena>
+  inline Value(ConsTag, Value&& car, Value&& cdr, Source* source = nullptr);
+  inline Value(ConsTag, Value&& car, Value&& cdr, std::pmr::memory_resource* resource);
+  template<typename Source = Arena>
+  inline Value(ArrayTag, std::vector<Value> arr, Source* source = nullptr) :
+    Value()
+  {
+    set_array(create<Array>(source, std::make_move_iterator(arr.begin()), std::make_move_iterator(arr.end()),
+                            resource(source)),
+              source ? ARENA : HEAP);
+  }
+  template<typename Source = Arena>
+  inline Value(IntArrayTag, std::vector<int> arr, Source* source = nullptr) :
+    Value()
+  {
+    set_int_array(create<IntArray>(source, arr.begin(), arr.end(), resource(source)), source ? ARENA : HEAP);
+  }
+  template<typename Source = Arena>
+  inline Value(RealArrayTag, std::vector<float> arr, Source* source = nullptr) :
+    Value()
+  {
+    set_real_array(create<RealArray>(source, arr.begin(), arr.end(), resource(source)), source ? ARENA : HEAP);
+  }
   template<typename... Args>
-  inline Value(ArrayTag, Args&&... args) :
-    m_line(0),
-    m_type(Type::ARRAY),
-    m_data(new std::vector<Value>{std::move(args)...})
+  inline Value(ArrayTag tag, Args&&... args) :
+    Value(tag, make_vector(std::move(args)...))
   {}
 
+  /** Unlike an initializer_list this moves the elements instead of
+      copying them */
+  template<typename... Args>
+  static std::vector<Value> make_vector(Args&&... args)
+  {
+    std::vector<Value> result;
+    result.reserve(sizeof...(args));
+    (result.emplace_back(std::move(args)), ...);
+    return result;
+  }
+
+  static std::pmr::memory_resource* resource(Arena* arena)
+  {
+    return arena ? arena : std::pmr::get_default_resource();
+  }
+
+  static std::pmr::memory_resource* resource(std::pmr::memory_resource* resource)
+  {
+    return resource ? resource : std::pmr::get_default_resource();
+  }
+
+  template<typename T, typename... Args>
+  static T* create(Arena* arena, Args&&... args)
+  {
+    if (arena) {
+      return arena->create<T>(std::forward<Args>(args)...);
+    } else {
+      return Pool::create<T>(std::forward<Args>(args)...);
+    }
+  }
+
+  template<typename T, typename... Args>
+  static T* create(std::pmr::memory_resource* resource, Args&&... args)
+  {
+    if (!resource) {
+      return Pool::create<T>(std::forward<Args>(args)...);
+    }
+
+    void* ptr = resource->allocate(sizeof(T), alignof(T));
+    try
+    {
+      return new (ptr) T(std::forward<Args>(args)...);
+    }
+    catch(...)
+    {
+      resource->deallocate(ptr, sizeof(T), alignof(T));
+      throw;
+    }
+  }
+
+  /** Strings and arrays go back to the resource of their allocator,
+      for an Arena that does nothing */
+  template<typename T>
+  static void release(T* ptr, unsigned storage)
+  {
+    if (storage == ARENA) {
+      std::pmr::memory_resource* const resource = ptr->get_allocator().resource();
+      std::destroy_at(ptr);
+      resource->deallocate(ptr, sizeof(T), alignof(T));
+    } else if (storage == SHARED) {
+      Pool::destroy(static_cast<Shared<T>*>(ptr));
+    } else {
+      Pool::destroy(ptr);
+    }
+  }
+
+  /** Heap strings and symbols never come from a memory_resource */
+  static void release(String* ptr, unsigned storage)
+  {
+    if (storage == SHARED) {
+      Pool::destroy(static_cast<Shared<String>*>(ptr));
+    } else {
+      Pool::destroy(ptr);
+    }
+  }
+
+  /** Arena cells are left alone, only the destructor is run */
+  static void release(Cons* cell, unsigned storage);
+
+  /** Returns true when the caller held the last reference, the count
+      is then left at one so the node can be taken apart in place */
+  static bool release_ref(std::atomic<unsigned>& refs)
+  {
+    if (refs.load(std::memory_order_acquire) == 1) {
+      return true;
+    } else if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      refs.store(1, std::memory_order_relaxed);
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  std::atomic<unsigned>& ref_count() const;
+
+  /** Drops a shared node that is still referenced elsewhere and
+      leaves nil behind */
+  void drop_shared();
+
+  /** Replaces a shared cons cell or array of any kind that is
+      referenced elsewhere with a copy of its own */
+  void unshare();
+
   void destroy();
+  void destroy_tree();
+  void copy_tree(Value const& other);
+
+  /** Take over the content of \a other without releasing our own,
+      leaves \a other as nil */
+  inline void take(Value& other)
+  {
+    assign(other);
+    other.set_nil();
+  }
+
+  inline bool is_container() const { return type() == Type::CONS || type() == Type::ARRAY; }
+  inline bool is_array_or_cons() const { return type() >= Type::CONS; }
+
+  /** Compares everything except the children of containers */
+  inline bool shallow_equal(Value const& other) const;
+
+  /** Compares arrays of different kinds element by element */
+  bool array_equal(Value const& other) const;
+
+  /** The element of a typed array as Value */
+  inline Value array_element(size_t idx) const;
 
   [[noreturn]]
   void type_error(const char* msg) const
   {
-    throw TypeError(m_line, msg);
+    throw TypeError(get_line(), msg);
   }
 
 public:
   Value(Value const& other);
 
-  inline Value(Value&& other) :
-    m_line(other.m_line),
-    m_type(other.m_type),
-    m_data(other.m_data)
+  inline Value(Value&& other) noexcept :
+    Value()
   {
-    other.m_type = Type::NIL;
+    take(other);
   }
 
+#ifdef SEXP_COMPACT_VALUE
+  inline Value() :
+    m_bits(0)
+  {}
+#else
   inline Value() :
     m_line(0),
+    m_storage(HEAP),
     m_type(Type::NIL),
     m_data()
   {}
+#endif
 
   inline ~Value()
   {
     destroy();
   }
 
-  inline Value& operator=(Value&& other)
+  inline Value& operator=(Value&& other) noexcept
   {
     destroy();
-
-    m_line = other.m_line;
-    m_type = other.m_type;
-    m_data = other.m_data;
-
-    other.m_type = Type::NIL;
-
+    take(other);
     return *this;
   }
 
@@ -195,18 +569,31 @@ public:
     return *this;
   }
 
-  inline Type get_type() const { return m_type; }
-
-  inline explicit operator bool() const { return m_type != Type::NIL; }
-
-  inline bool is_nil() const { return m_type == Type::NIL; }
-  inline bool is_boolean() const { return m_type == Type::BOOLEAN; }
-  inline bool is_integer() const { return m_type == Type::INTEGER; }
-  inline bool is_real() const { return (m_type == Type::REAL || m_type == Type::INTEGER); }
-  inline bool is_string() const { return m_type == Type::STRING; }
-  inline bool is_symbol() const { return m_type == Type::SYMBOL; }
-  inline bool is_cons() const { return m_type == Type::CONS; }
-  inline bool is_array() const { return m_type == Type::ARRAY; }
+  /** Turns the strings, cons cells and arrays of the tree into
+      reference counted nodes, copies of the tree or of any subtree
+      only increment a count afterwards. Modifying a shared node
+      copies it first, references to children obtained through
+      non-const accessors are invalidated by copying the tree. Shared
+      nodes live on the heap, the parts of the tree that came from an
+      Arena or a memory_resource are copied out of it. */
+  void share();
+  inline bool is_shared() const { return storage() == SHARED && type() != Type::NIL; }
+
+  inline Type get_type() const { return type(); }
+
+  inline explicit operator bool() const { return type() != Type::NIL; }
+
+  inline bool is_nil() const { return type() == Type::NIL; }
+  inline bool is_boolean() const { return type() == Type::BOOLEAN; }
+  inline bool is_integer() const { return type() == Type::INTEGER; }
+  inline bool is_real() const { return (type() == Type::REAL || type() == Type::INTEGER); }
+  inline bool is_string() const { return type() == Type::STRING; }
+  inline bool is_symbol() const { return type() == Type::SYMBOL; }
+  inline bool is_cons() const { return type() == Type::CONS; }
+  /** True for all three kinds of arrays */
+  inline bool is_array() const { return type() >= Type::ARRAY; }
+  inline bool is_int_array() const { return type() == Type::INT_ARRAY; }
+  inline bool is_real_array() const { return type() == Type::REAL_ARRAY; }
 
   Value const& get_car() const;
   Value const& get_cdr() const;
@@ -217,13 +604,33 @@ public:
   void set_car(Value&& sexpr);
   void set_cdr(Value&& sexpr);
 
+  /** Appending anything but an integer to an INT_ARRAY or anything
+      but a real to a REAL_ARRAY turns it into a generic ARRAY */
   void append(Value&& sexpr);
 
+  /** Turns an INT_ARRAY or REAL_ARRAY into a generic ARRAY, does
+      nothing for those */
+  void make_generic_array();
+
   bool as_bool() const;
   int as_int() const;
   float as_float() const;
-  std::string const& as_string() const;
-  std::vector<Value> const& as_array() const;
+  /** Returns a copy, as short strings are stored inline in the Value
+      and strings from an Arena or a memory_resource in a
+      std::pmr::string, so there is no std::string to refer to. Prefer
+      as_string_view(), which never allocates. */
+  std::string as_string() const;
+  std::string_view as_string_view() const;
+  /** Only for generic arrays, see make_generic_array(). The vector
+      uses the memory_resource the array was built from, see Arena. */
+  std::pmr::vector<Value> const& as_array() const;
+  std::span<int const> as_int_array() const;
+  std::span<float const> as_real_array() const;
+  std::span<int> as_int_array();
+  std::span<float> as_real_array();
+
+  /** Number of elements of any kind of array */
+  int get_array_size() const;
 
   bool operator==(Value const& other) const;
 
@@ -236,29 +643,140 @@ struct Value::Cons
   Value cdr;
 };
 
+/** Cons cell from a std::pmr::memory_resource, which doesn't tell the
+    cell apart from an Arena one otherwise */
+struct Value::ResourceCons : public Value::Cons
+{
+  ResourceCons(Value&& car_, Value&& cdr_, std::pmr::memory_resource* resource_) :
+    Cons{std::move(car_), std::move(cdr_)},
+    resource(resource_)
+  {}
+
+  std::pmr::memory_resource* resource;
+};
+
+template<typename Source>
 inline
-Value::Value(ConsTag, Value&& car, Value&& cdr) :
-  m_line(0),
-  m_type(Type::CONS),
-  m_data(new Cons{std::move(car), std::move(cdr)})
-{}
+Value::Value(ConsTag, Value&& car, Value&& cdr, Source* source) :
+  Value()
+{
+  set_cons(create<Cons>(source, std::move(car), std::move(cdr)), source ? ARENA : HEAP);
+}
+
+inline
+Value::Value(ConsTag, Value&& car, Value&& cdr, std::pmr::memory_resource* resource) :
+  Value()
+{
+  if (resource) {
+    set_cons(create<ResourceCons>(resource, std::move(car), std::move(cdr), resource), RESOURCE);
+  } else {
+    set_cons(Pool::create<Cons>(std::move(car), std::move(cdr)), HEAP);
+  }
+}
+
+inline void
+Value::release(Cons* cell, unsigned storage)
+{
+  if (storage == ARENA) {
+    std::destroy_at(cell);
+  } else if (storage == RESOURCE) {
+    ResourceCons* const node = static_cast<ResourceCons*>(cell);
+    std::pmr::memory_resource* const resource = node->resource;
+    std::destroy_at(node);
+    resource->deallocate(node, sizeof(ResourceCons), alignof(ResourceCons));
+  } else if (storage == SHARED) {
+    Pool::destroy(static_cast<Shared<Cons>*>(cell));
+  } else {
+    Pool::destroy(cell);
+  }
+}
+
+inline std::atomic<unsigned>&
+Value::ref_count() const
+{
+  assert(is_shared());
+  switch(type())
+  {
+    case Type::STRING:
+    case Type::SYMBOL:
+      return static_cast<Shared<String>*>(string_ptr())->refs;
+
+    case Type::CONS:
+      return static_cast<Shared<Cons>*>(cons_ptr())->refs;
+
+    case Type::INT_ARRAY:
+      return static_cast<Shared<IntArray>*>(int_array_ptr())->refs;
+
+    case Type::REAL_ARRAY:
+      return static_cast<Shared<RealArray>*>(real_array_ptr())->refs;
+
+    default:
+      return static_cast<Shared<Array>*>(array_ptr())->refs;
+  }
+}
+
+inline void
+Value::drop_shared()
+{
+  if (is_shared() && !release_ref(ref_count()))
+  {
+    set_nil();
+  }
+}
+
+inline void
+Value::unshare()
+{
+  if (is_shared() && is_array_or_cons() && ref_count().load(std::memory_order_acquire) != 1)
+  {
+    // children are shared as well, so this is only a shallow copy
+    Value copy;
+    if (type() == Type::CONS) {
+      Cons const& cell = *cons_ptr();
+      copy.set_cons(Pool::create<Shared<Cons> >(Cons{Value(cell.car), Value(cell.cdr)}), SHARED);
+    } else if (type() == Type::INT_ARRAY) {
+      copy.set_int_array(Pool::create<Shared<IntArray> >(IntArray(*int_array_ptr())), SHARED);
+    } else if (type() == Type::REAL_ARRAY) {
+      copy.set_real_array(Pool::create<Shared<RealArray> >(RealArray(*real_array_ptr())), SHARED);
+    } else {
+      copy.set_array(Pool::create<Shared<Array> >(Array(*array_ptr())), SHARED);
+    }
+    copy.set_line(get_line());
+    *this = std::move(copy);
+  }
+}
 
 inline void
 Value::destroy()
 {
-  switch(m_type)
+  switch(type())
   {
     case Value::Type::STRING:
     case Value::Type::SYMBOL:
-      delete m_data.m_string;
+      if (storage() == SHARED && !release_ref(ref_count())) {
+        // still referenced elsewhere
+      } else if (storage() == ARENA) {
+        release(arena_string_ptr(), ARENA);
+      } else if (storage() != INLINE) {
+        release(string_ptr(), storage());
+      }
       break;
 
-    case Value::Type::CONS:
-      delete m_data.m_cons;
+    case Value::Type::INT_ARRAY:
+      if (storage() != SHARED || release_ref(ref_count())) {
+        release(int_array_ptr(), storage());
+      }
       break;
 
+    case Value::Type::REAL_ARRAY:
+      if (storage() != SHARED || release_ref(ref_count())) {
+        release(real_array_ptr(), storage());
+      }
+      break;
+
+    case Value::Type::CONS:
     case Value::Type::ARRAY:
-      delete m_data.m_array;
+      destroy_tree();
       break;
 
     default:
@@ -267,72 +785,226 @@ Value::destroy()
   }
 }
 
+inline void
+Value::destroy_tree()
+{
+  // Children are detached before a cons cell or array gets deleted, so
+  // deletion never recurses. Cons cells in car position are rotated
+  // into the cdr chain, so plain trees of cons cells need no extra
+  // memory, only containers inside of arrays go onto the worklist.
+  // Shared nodes that are referenced elsewhere are left alone.
+  std::vector<Value> pending;
+  Value cur;
+  cur.take(*this);
+
+  while(true)
+  {
+    cur.drop_shared();
+    if (cur.type() == Type::CONS)
+    {
+      Cons* cell = cur.cons_ptr();
+      cell->car.drop_shared();
+      if (cell->car.type() == Type::CONS)
+      {
+        Cons* left = cell->car.cons_ptr();
+        unsigned const left_storage = cell->car.storage();
+        cell->car.take(left->cdr);
+        left->cdr.set_cons(cell, cur.storage());
+        cur.set_cons(left, left_storage);
+        continue;
+      }
+      else if (cell->car.type() == Type::ARRAY)
+      {
+        pending.emplace_back();
+        pending.back().take(cell->car);
+      }
+
+      unsigned const storage = cur.storage();
+      cur.take(cell->cdr);
+      release(cell, storage);
+    }
+    else if (cur.type() == Type::ARRAY)
+    {
+      Array* arr = cur.array_ptr();
+      for(Value& item : *arr)
+      {
+        if (item.is_container())
+        {
+          pending.emplace_back();
+          pending.back().take(item);
+        }
+      }
+      unsigned const storage = cur.storage();
+      cur.set_nil();
+      release(arr, storage);
+    }
+    else
+    {
+      cur.destroy();
+      cur.set_nil();
+
+      if (pending.empty())
+      {
+        break;
+      }
+      cur.take(pending.back());
+      pending.pop_back();
+    }
+  }
+}
+
 inline
 Value::Value(Value const& other) :
-  m_line(other.m_line),
-  m_type(other.m_type)
+  Value()
 {
-  switch(m_type)
+  if (other.is_shared())
   {
-    case Type::NIL:
-      break;
-
-    case Type::BOOLEAN:
-      m_data.m_bool = other.m_data.m_bool;
-      break;
-
-    case Type::INTEGER:
-      m_data.m_int = other.m_data.m_int;
-      break;
-
-    case Type::REAL:
-      m_data.m_float = other.m_data.m_float;
-      break;
-
-    case Type::STRING:
-    case Type::SYMBOL:
-      m_data.m_string = new std::string(*other.m_data.m_string);
-      break;
+    other.ref_count().fetch_add(1, std::memory_order_relaxed);
+    assign(other);
+  }
+  else if (other.is_container())
+  {
+    try
+    {
+      copy_tree(other);
+    }
+    catch(...)
+    {
+      destroy();
+      throw;
+    }
+  }
+  else if (other.type() == Type::STRING && other.storage() != INLINE)
+  {
+    set_string(Pool::create<String>(other.as_string_view()), HEAP);
+    set_line(other.get_line());
+  }
+  else if (other.type() == Type::SYMBOL && other.storage() != INLINE)
+  {
+    set_symbol(Pool::create<String>(*other.string_ptr()), HEAP);
+    set_line(other.get_line());
+  }
+  else if (other.type() == Type::INT_ARRAY)
+  {
+    set_int_array(Pool::create<IntArray>(*other.int_array_ptr()), HEAP);
+    set_line(other.get_line());
+  }
+  else if (other.type() == Type::REAL_ARRAY)
+  {
+    set_real_array(Pool::create<RealArray>(*other.real_array_ptr()), HEAP);
+    set_line(other.get_line());
+  }
+  else
+  {
+    // the remaining types don't own any memory
+    assign(other);
+  }
+}
 
-    case Type::CONS:
-      m_data.m_cons = new Cons(*other.m_data.m_cons);
-      break;
+inline void
+Value::copy_tree(Value const& other)
+{
+  // cdr chains are followed in a loop, containers in car position or
+  // in arrays are remembered and copied once the chain is done, the
+  // copy is kept in a consistent state in case allocation fails
+  std::vector<std::pair<Value*, Value const*> > pending;
+  Value* dst = this;
+  Value const* src = &other;
+
+  while(true)
+  {
+    if (src->type() == Type::CONS && !src->is_shared())
+    {
+      Cons const* src_cell = src->cons_ptr();
+      Cons* dst_cell = Pool::create<Cons>();
+      dst->set_cons(dst_cell, HEAP);
+      dst->set_line(src->get_line());
+
+      if (src_cell->car.is_container()) {
+        pending.emplace_back(&dst_cell->car, &src_cell->car);
+      } else {
+        new (&dst_cell->car) Value(src_cell->car);
+      }
+
+      dst = &dst_cell->cdr;
+      src = &src_cell->cdr;
+      continue;
+    }
+    else if (src->type() == Type::ARRAY && !src->is_shared())
+    {
+      Array const& src_arr = *src->array_ptr();
+      Array& dst_arr = *Pool::create<Array>(src_arr.size());
+      dst->set_array(&dst_arr, HEAP);
+      dst->set_line(src->get_line());
+
+      for(size_t i = 0; i < src_arr.size(); ++i)
+      {
+        if (src_arr[i].is_container()) {
+          pending.emplace_back(&dst_arr[i], &src_arr[i]);
+        } else {
+          new (&dst_arr[i]) Value(src_arr[i]);
+        }
+      }
+    }
+    else
+    {
+      new (dst) Value(*src);
+    }
 
-    case Type::ARRAY:
-      m_data.m_array = new std::vector<Value>(*other.m_data.m_array);
+    if (pending.empty())
+    {
       break;
+    }
+    dst = pending.back().first;
+    src = pending.back().second;
+    pending.pop_back();
   }
 }
 
 inline bool
-Value::operator==(Value const& rhs) const
+Value::shallow_equal(Value const& rhs) const
 {
-  if (m_type == rhs.m_type)
+  if (type() != rhs.type() && is_array() && rhs.is_array())
+  {
+    return array_equal(rhs);
+  }
+  else if (type() == rhs.type())
   {
-    switch(m_type)
+    switch(type())
     {
       case Type::NIL:
         return true;
 
       case Value::Type::BOOLEAN:
-        return m_data.m_bool == rhs.m_data.m_bool;
+        return bool_value() == rhs.bool_value();
 
       case Value::Type::INTEGER:
-        return m_data.m_int == rhs.m_data.m_int;
+        return int_value() == rhs.int_value();
 
       case Value::Type::REAL:
-        return m_data.m_float == rhs.m_data.m_float;
+        return float_value() == rhs.float_value();
 
       case Value::Type::STRING:
+        return as_string_view() == rhs.as_string_view();
+
       case Value::Type::SYMBOL:
-        return *m_data.m_string == *rhs.m_data.m_string;
+        if (storage() == INLINE && rhs.storage() == INLINE) {
+          return symbol_ptr() == rhs.symbol_ptr();
+        } else {
+          return as_string_view() == rhs.as_string_view();
+        }
 
       case Value::Type::CONS:
-        return (m_data.m_cons->car == rhs.m_data.m_cons->car &&
-                m_data.m_cons->cdr == rhs.m_data.m_cons->cdr);
+        return true;
 
       case Value::Type::ARRAY:
-        return *m_data.m_array == *rhs.m_data.m_array;
+        return array_ptr()->size() == rhs.array_ptr()->size();
+
+      case Value::Type::INT_ARRAY:
+        return *int_array_ptr() == *rhs.int_array_ptr();
+
+      case Value::Type::REAL_ARRAY:
+        return *real_array_ptr() == *rhs.real_array_ptr();
     }
     assert(false && "should never be reached");
     return false;
@@ -343,12 +1015,67 @@ Value::operator==(Value const& rhs) const
   }
 }
 
+inline bool
+Value::operator==(Value const& rhs) const
+{
+  // same traversal as copy_tree(), but nothing needs to be built
+  std::vector<std::pair<Value const*, Value const*> > pending;
+  Value const* lhs_cur = this;
+  Value const* rhs_cur = &rhs;
+
+  while(true)
+  {
+    if (!lhs_cur->shallow_equal(*rhs_cur))
+    {
+      return false;
+    }
+
+    // shared nodes are equal to themselves without looking at them
+    if (lhs_cur->type() == Type::CONS && lhs_cur->cons_ptr() != rhs_cur->cons_ptr())
+    {
+      Cons const* lhs_cell = lhs_cur->cons_ptr();
+      Cons const* rhs_cell = rhs_cur->cons_ptr();
+      if (lhs_cell->car.is_container()) {
+        pending.emplace_back(&lhs_cell->car, &rhs_cell->car);
+      } else if (!lhs_cell->car.shallow_equal(rhs_cell->car)) {
+        return false;
+      }
+
+      lhs_cur = &lhs_cell->cdr;
+      rhs_cur = &rhs_cell->cdr;
+      continue;
+    }
+    else if (lhs_cur->type() == Type::ARRAY && rhs_cur->type() == Type::ARRAY &&
+             lhs_cur->array_ptr() != rhs_cur->array_ptr())
+    {
+      Array const& lhs_arr = *lhs_cur->array_ptr();
+      Array const& rhs_arr = *rhs_cur->array_ptr();
+      for(size_t i = 0; i < lhs_arr.size(); ++i)
+      {
+        if (lhs_arr[i].is_container()) {
+          pending.emplace_back(&lhs_arr[i], &rhs_arr[i]);
+        } else if (!lhs_arr[i].shallow_equal(rhs_arr[i])) {
+          return false;
+        }
+      }
+    }
+
+    if (pending.empty())
+    {
+      return true;
+    }
+    lhs_cur = pending.back().first;
+    rhs_cur = pending.back().second;
+    pending.pop_back();
+  }
+}
+
 inline Value const&
 Value::get_car() const
 {
-  if (m_type == Type::CONS)
+  if (type() == Type::CONS)
   {
-    return m_data.m_cons->car;
+    return cons_ptr()->car;
   }
   else
   {
@@ -359,9 +1086,9 @@ Value::get_car() const
 inline Value const&
 Value::get_cdr() const
 {
-  if (m_type == Type::CONS)
+  if (type() == Type::CONS)
   {
-  return m_data.m_cons->cdr;
+  return cons_ptr()->cdr;
   }
   else
   {
@@ -372,21 +1099,24 @@ Value::get_cdr() const
 inline Value&
 Value::get_car()
 {
+  unshare();
   return const_cast<Value&>(static_cast<Value const&>(*this).get_car());
 }
 
 inline Value&
 Value::get_cdr()
 {
+  unshare();
   return const_cast<Value&>(static_cast<Value const&>(*this).get_cdr());
 }
 
 inline void
 Value::set_car(Value&& sexpr)
 {
-  if (m_type == Type::CONS)
+  if (type() == Type::CONS)
   {
-    m_data.m_cons->car = std::move(sexpr);
+    unshare();
+    cons_ptr()->car = std::move(sexpr);
   }
   else
   {
@@ -397,9 +1127,10 @@ Value::set_car(Value&& sexpr)
 inline void
 Value::set_cdr(Value&& sexpr)
 {
-  if (m_type == Type::CONS)
+  if (type() == Type::CONS)
   {
-    m_data.m_cons->cdr = std::move(sexpr);
+    unshare();
+    cons_ptr()->cdr = std::move(sexpr);
   }
   else
   {
@@ -407,12 +1138,34 @@ Value::set_cdr(Value&& sexpr)
   }
 }
 
+inline Value
+Value::array_element(size_t idx) const
+{
+  if (type() == Type::INT_ARRAY) {
+    return Value::integer((*int_array_ptr())[idx]);
+  } else {
+    return Value::real((*real_array_ptr())[idx]);
+  }
+}
+
 inline void
 Value::append(Value&& sexpr)
 {
-  if (m_type == Type::ARRAY)
+  if (type() == Type::INT_ARRAY && sexpr.type() == Type::INTEGER)
   {
-    m_data.m_array->push_back(std::move(sexpr));
+    unshare();
+    int_array_ptr()->push_back(sexpr.int_value());
+  }
+  else if (type() == Type::REAL_ARRAY && sexpr.type() == Type::REAL)
+  {
+    unshare();
+    real_array_ptr()->push_back(sexpr.float_value());
+  }
+  else if (is_array())
+  {
+    make_generic_array();
+    unshare();
+    array_ptr()->push_back(std::move(sexpr));
   }
   else
   {
@@ -423,9 +1176,9 @@ Value::append(Value&& sexpr)
 inline bool
 Value::as_bool() const
 {
-  if (m_type == Type::BOOLEAN)
+  if (type() == Type::BOOLEAN)
   {
-    return m_data.m_bool;
+    return bool_value();
   }
   else
   {
@@ -436,9 +1189,9 @@ Value::as_bool() const
 inline int
 Value::as_int() const
 {
-  if (m_type == Type::INTEGER)
+  if (type() == Type::INTEGER)
   {
-    return m_data.m_int;
+    return int_value();
   }
   else
   {
@@ -450,13 +1203,13 @@ Value::as_int() const
 inline float
 Value::as_float() const
 {
-  if (m_type == Type::REAL)
+  if (type() == Type::REAL)
   {
-    return m_data.m_float;
+    return float_value();
   }
-  else if (m_type == Type::INTEGER)
+  else if (type() == Type::INTEGER)
   {
-    return static_cast<float>(m_data.m_int);
+    return static_cast<float>(int_value());
   }
   else
   {
@@ -464,25 +1217,52 @@ Value::as_float() const
   }
 }
 
-inline std::string const&
+inline std::string
 Value::as_string() const
 {
-  if (m_type == Type::SYMBOL || m_type == Type::STRING)
+  if (type() == Type::SYMBOL || type() == Type::STRING)
   {
-    return *m_data.m_string;
+    return std::string(as_string_view());
   }
   else
   {
-    type_error("sexp::Value::as_float(): wrong type, expected Type::SYMBOL or Type::STRING");
+    type_error("sexp::Value::as_string(): wrong type, expected Type::SYMBOL or Type::STRING");
   }
 }
 
-inline std::vector<Value> const&
+inline std::string_view
+Value::as_string_view() const
+{
+  if (type() == Type::SYMBOL)
+  {
+    if (storage() == INLINE) {
+      return *symbol_ptr();
+    } else {
+      return *string_ptr();
+    }
+  }
+  else if (type() == Type::STRING)
+  {
+    if (storage() == INLINE) {
+      return short_view();
+    } else if (storage() == ARENA) {
+      return *arena_string_ptr();
+    } else {
+      return *string_ptr();
+    }
+  }
+  else
+  {
+    type_error("sexp::Value::as_string_view(): wrong type, expected Type::SYMBOL or Type::STRING");
+  }
+}
+
+inline std::pmr::vector<Value> const&
 Value::as_array() const
 {
-  if (m_type == Type::ARRAY)
+  if (type() == Type::ARRAY)
   {
-    return *m_data.m_array;
+    return *array_ptr();
   }
   else
   {
@@ -490,6 +1270,67 @@ Value::as_array() const
   }
 }
 
+inline std::span<int const>
+Value::as_int_array() const
+{
+  if (type() == Type::INT_ARRAY)
+  {
+    return *int_array_ptr();
+  }
+  else
+  {
+    type_error("sexp::Value::as_int_array(): wrong type, expected Type::INT_ARRAY");
+  }
+}
+
+inline std::span<float const>
+Value::as_real_array() const
+{
+  if (type() == Type::REAL_ARRAY)
+  {
+    return *real_array_ptr();
+  }
+  else
+  {
+    type_error("sexp::Value::as_real_array(): wrong type, expected Type::REAL_ARRAY");
+  }
+}
+
+inline std::span<int>
+Value::as_int_array()
+{
+  unshare();
+  std::span<int const> const arr = static_cast<Value const&>(*this).as_int_array();
+  return std::span<int>(const_cast<int*>(arr.data()), arr.size());
+}
+
+inline std::span<float>
+Value::as_real_array()
+{
+  unshare();
+  std::span<float const> const arr = static_cast<Value const&>(*this).as_real_array();
+  return std::span<float>(const_cast<float*>(arr.data()), arr.size());
+}
+
+inline int
+Value::get_array_size() const
+{
+  switch(type())
+  {
+    case Type::ARRAY:
+      return static_cast<int>(array_ptr()->size());
+
+    case Type::INT_ARRAY:
+      return static_cast<int>(int_array_ptr()->size());
+
+    case Type::REAL_ARRAY:
+      return static_cast<int>(real_array_ptr()->size());
+
+    default:
+      type_error("sexp::Value::get_array_size(): wrong type, expected Type::ARRAY");
+  }
+}
+
 } // namespace sexp
 
 #endif
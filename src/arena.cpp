@@ -0,0 +1,89 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sexp/arena.hpp"
+
+namespace sexp {
+
+Arena::Arena(size_t chunk_size) :
+  m_chunk_size(chunk_size),
+  m_capacity(0),
+  m_pos(nullptr),
+  m_end(nullptr),
+  m_chunks()
+{
+}
+
+Arena::~Arena()
+{
+}
+
+void
+Arena::clear()
+{
+  // keep the chunk that is currently being filled, oversized chunks
+  // are not worth keeping around
+  std::unique_ptr<char[]> current;
+  for (auto& chunk : m_chunks)
+  {
+    if (chunk.get() + m_chunk_size == m_end)
+    {
+      current = std::move(chunk);
+      break;
+    }
+  }
+
+  m_chunks.clear();
+  if (current)
+  {
+    m_pos = current.get();
+    m_capacity = m_chunk_size;
+    m_chunks.push_back(std::move(current));
+  }
+  else
+  {
+    m_pos = nullptr;
+    m_end = nullptr;
+    m_capacity = 0;
+  }
+}
+
+void*
+Arena::allocate_slow(size_t size, size_t alignment)
+{
+  // oversized requests get a chunk of their own, the current chunk
+  // stays active as it likely still has room for the small stuff
+  size_t const chunk_size = size + alignment;
+  if (chunk_size > m_chunk_size / 4)
+  {
+    m_chunks.emplace_back(new char[chunk_size]);
+    m_capacity += chunk_size;
+    uintptr_t const pos = (reinterpret_cast<uintptr_t>(m_chunks.back().get()) + alignment - 1) & ~(alignment - 1);
+    return reinterpret_cast<void*>(pos);
+  }
+  else
+  {
+    m_chunks.emplace_back(new char[m_chunk_size]);
+    m_capacity += m_chunk_size;
+    m_pos = m_chunks.back().get();
+    m_end = m_pos + m_chunk_size;
+    return allocate(size, alignment);
+  }
+}
+
+} // namespace sexp
+
+/* EOF */
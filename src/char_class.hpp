@@ -0,0 +1,110 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_CHAR_CLASS_HPP
+#define HEADER_SEXP_CHAR_CLASS_HPP
+
+#include <array>
+#include <bit>
+#include <stdint.h>
+#include <string_view>
+
+#include "simd.hpp"
+
+namespace sexp {
+
+/** Character classes as used by the Lexer. The lower three bits hold
+    the role of the character within a number, the others are flags. */
+enum CharClass : uint8_t
+{
+  CHAR_OTHER = 0,
+  CHAR_DIGIT = 1,
+  CHAR_SIGN = 2,     // '+' and '-'
+  CHAR_POINT = 3,    // '.'
+  CHAR_EXPONENT = 4, // 'e' and 'E'
+  CHAR_NUMBER_MASK = 7,
+
+  /** Whitespace as in the "C" locale */
+  CHAR_SPACE = 1 << 3,
+
+  /** Characters that end a symbol or number: '"', '(', ')', ';' and,
+      for historic reasons, '\0' */
+  CHAR_DELIMITER = 1 << 4,
+
+  /** Characters allowed in '#' constants */
+  CHAR_IDENTIFIER = 1 << 5,
+
+  CHAR_TOKEN_END = CHAR_SPACE | CHAR_DELIMITER
+};
+
+inline constexpr std::array<uint8_t, 256> make_char_classes()
+{
+  std::array<uint8_t, 256> table{};
+  auto const add = [&table](std::string_view chars, uint8_t cls) {
+    for(char c : chars) {
+      table[static_cast<unsigned char>(c)] |= cls;
+    }
+  };
+
+  add("0123456789", CHAR_DIGIT | CHAR_IDENTIFIER);
+  add("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_", CHAR_IDENTIFIER);
+  add("eE", CHAR_EXPONENT);
+  add("+-", CHAR_SIGN);
+  add(".", CHAR_POINT);
+  add(" \t\n\v\f\r", CHAR_SPACE);
+  add(std::string_view("\"();\0", 5), CHAR_DELIMITER);
+  return table;
+}
+
+inline constexpr std::array<uint8_t, 256> char_classes = make_char_classes();
+
+/** Class of the character \a c, EOF is classified as CHAR_OTHER */
+inline uint8_t char_class(int c)
+{
+  return char_classes[static_cast<unsigned char>(c)];
+}
+
+inline bool is_space(int c) { return (char_class(c) & CHAR_SPACE) != 0; }
+
+/** Returns the first of the characters \a a, \a b, \a c or \a d in
+    [begin, end), or \a end when there is none */
+inline char const* find_any(char const* begin, char const* end, char a, char b, char c, char d)
+{
+#ifdef SEXP_HAVE_SSE2
+  for(; end - begin >= 16; begin += 16)
+  {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(begin)); // NOLINT
+    __m128i const match = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(a)), _mm_cmpeq_epi8(v, _mm_set1_epi8(b))),
+      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)), _mm_cmpeq_epi8(v, _mm_set1_epi8(d))));
+    unsigned const mask = static_cast<unsigned>(_mm_movemask_epi8(match));
+    if (mask) {
+      return begin + std::countr_zero(mask);
+    }
+  }
+#endif
+
+  while(begin < end && *begin != a && *begin != b && *begin != c && *begin != d) {
+    ++begin;
+  }
+  return begin;
+}
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
@@ -0,0 +1,47 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sexp/event_parser.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace sexp {
+
+EventParserBase::EventParserBase(Lexer& lexer, int max_depth) :
+  m_lexer(lexer),
+  m_token(m_lexer.get_next_token()),
+  m_max_depth(max_depth),
+  m_stack()
+{
+}
+
+EventParserBase::~EventParserBase()
+{
+}
+
+void
+EventParserBase::parse_error(const char* msg) const
+{
+  std::stringstream emsg;
+  emsg << "Parse Error at line " << m_lexer.get_line_number()
+       << ": " << msg;
+  throw std::runtime_error(emsg.str());
+}
+
+} // namespace sexp
+
+/* EOF */
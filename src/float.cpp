@@ -21,10 +21,29 @@
 #include <charconv>
 #include <limits>
 #include <sstream>
+#include <stdexcept>
 
 namespace sexp {
 
-float string2float(const std::string& text)
+int string2int(std::string_view text)
+{
+  char const* start = text.data();
+
+  // A leading + (e.g. "+5") is not accepted by from_chars(), so skip it
+  if (!text.empty() && text[0] == '+') {
+    start += 1;
+  }
+
+  int result = 0;
+  auto err = std::from_chars(start, text.data() + text.size(), result);
+  if (err.ec == std::errc::result_out_of_range) {
+    throw std::out_of_range("sexp::string2int(): integer out of range");
+  }
+  assert(err.ec == std::errc());
+  return result;
+}
+
+float string2float(std::string_view text)
 {
   char const* start = text.data();
 
@@ -20,10 +20,15 @@
 
 #include <ostream>
 #include <string>
+#include <string_view>
 
 namespace sexp {
 
-float string2float(const std::string& text);
+/** Converts an integer token as produced by the Lexer, throws
+    std::out_of_range when it doesn't fit into an int */
+int string2int(std::string_view text);
+
+float string2float(std::string_view text);
 void float2string(std::ostream& os, float value);
 
 } // namespace sexp
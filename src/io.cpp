@@ -23,7 +23,7 @@
 
 namespace sexp {
 
-void escape_string(std::ostream& os, std::string const& text)
+void escape_string(std::ostream& os, std::string_view text)
 {
   os << '"';
   for(size_t i = 0; i < text.size(); ++i)
@@ -79,7 +79,7 @@ std::ostream& operator<<(std::ostream& os, Value const& sx)
       break;
 
     case Value::Type::STRING:
-      escape_string(os, sx.as_string());
+      escape_string(os, sx.as_string_view());
       break;
 
     case Value::Type::INTEGER:
@@ -91,7 +91,7 @@ std::ostream& operator<<(std::ostream& os, Value const& sx)
       break;
 
     case Value::Type::SYMBOL:
-      os << sx.as_string();
+      os << sx.as_string_view();
       break;
 
     case Value::Type::BOOLEAN:
@@ -110,6 +110,32 @@ std::ostream& operator<<(std::ostream& os, Value const& sx)
         os << ")";
       }
       break;
+
+    case Value::Type::INT_ARRAY:
+      {
+        os << "#(";
+        auto const arr = sx.as_int_array();
+        for(size_t i = 0; i != arr.size(); ++i)
+        {
+          if (i != 0) { os << ' '; }
+          os << arr[i];
+        }
+        os << ")";
+      }
+      break;
+
+    case Value::Type::REAL_ARRAY:
+      {
+        os << "#(";
+        auto const arr = sx.as_real_array();
+        for(size_t i = 0; i != arr.size(); ++i)
+        {
+          if (i != 0) { os << ' '; }
+          float2string(os, arr[i]);
+        }
+        os << ")";
+      }
+      break;
   }
 
   return os;
@@ -0,0 +1,459 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sexp/lazy_document.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include "sexp/lexer.hpp"
+#include "sexp/parser.hpp"
+#include "char_class.hpp"
+#include "mapped_file.hpp"
+#include "structural_index.hpp"
+
+namespace sexp {
+
+namespace {
+
+bool is_delimiter(char c)
+{
+  return (char_class(c) & CHAR_TOKEN_END) != 0;
+}
+
+} // namespace
+
+LazyDocument::LazyDocument(std::string_view text, bool use_arrays) :
+  m_file(),
+  m_storage(),
+  m_text(text),
+  m_use_arrays(use_arrays),
+  m_index(),
+  m_match(),
+  m_cache()
+{
+  build();
+}
+
+LazyDocument::LazyDocument(FileTag, std::string const& filename, bool use_arrays) :
+  m_file(std::make_unique<MappedFile>(filename)),
+  m_storage(),
+  m_text(),
+  m_use_arrays(use_arrays),
+  m_index(),
+  m_match(),
+  m_cache()
+{
+  if (m_file->is_mapped())
+  {
+    m_text = m_file->get_data();
+  }
+  else
+  {
+    std::ifstream fin(filename, std::ios::binary);
+    if (!fin)
+    {
+      throw std::runtime_error("failed to open " + filename);
+    }
+    m_storage.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+    m_text = m_storage;
+  }
+  build();
+}
+
+LazyDocument::~LazyDocument()
+{
+}
+
+LazyDocument
+LazyDocument::from_file(std::string const& filename, bool use_arrays)
+{
+  return LazyDocument(FileTag(), filename, use_arrays);
+}
+
+void
+LazyDocument::build()
+{
+  if (m_text.size() > UINT32_MAX)
+  {
+    throw std::runtime_error("sexp::LazyDocument: input larger than 4GB");
+  }
+
+  m_index = std::make_unique<StructuralIndex>(m_text);
+  std::vector<uint32_t> const& starts = m_index->get_starts();
+
+  // match up the parentheses, everything else is left for later
+  m_match.resize(starts.size());
+  std::vector<uint32_t> stack;
+  for(uint32_t idx = 0; idx < starts.size(); ++idx)
+  {
+    char const c = m_text[starts[idx]];
+    if (c == '(')
+    {
+      stack.push_back(idx);
+    }
+    else if (c == ')')
+    {
+      if (stack.empty())
+      {
+        parse_error(starts[idx], "Unexpected ')'.");
+      }
+      m_match[stack.back()] = idx;
+      stack.pop_back();
+    }
+  }
+
+  if (m_index->has_open_string())
+  {
+    parse_error(m_text.size(), "EOF while parsing string.");
+  }
+  else if (!stack.empty())
+  {
+    parse_error(m_text.size(), "Unexpected EOF.");
+  }
+}
+
+void
+LazyDocument::parse_error(size_t pos, const char* msg) const
+{
+  std::stringstream emsg;
+  emsg << "Parse Error at line " << m_index->newlines_before(pos)
+       << ": " << msg;
+  throw std::runtime_error(emsg.str());
+}
+
+LazyValue
+LazyDocument::get_root() const
+{
+  if (m_index->get_starts().empty())
+  {
+    return LazyValue();
+  }
+  else
+  {
+    return LazyValue(this, 0, LazyValue::ELEMENT);
+  }
+}
+
+LazyValue
+LazyDocument::get_forms() const
+{
+  return make_tail(0);
+}
+
+size_t
+LazyDocument::offset(uint32_t idx) const
+{
+  return m_index->get_starts()[idx];
+}
+
+bool
+LazyDocument::is_open(uint32_t idx) const
+{
+  return m_text[offset(idx)] == '(';
+}
+
+bool
+LazyDocument::is_array_start(uint32_t idx) const
+{
+  size_t const pos = offset(idx);
+  if (m_text[pos] == '#')
+  {
+    return (idx + 1 < m_index->get_starts().size() &&
+            offset(idx + 1) == pos + 1 &&
+            m_text[pos + 1] == '(');
+  }
+  else
+  {
+    return m_use_arrays && m_text[pos] == '(';
+  }
+}
+
+bool
+LazyDocument::is_dot(uint32_t idx) const
+{
+  size_t const pos = offset(idx);
+  return (m_text[pos] == '.' &&
+          (pos + 1 == m_text.size() || is_delimiter(m_text[pos + 1])));
+}
+
+bool
+LazyDocument::is_end(uint32_t idx) const
+{
+  return idx >= m_index->get_starts().size() || m_text[offset(idx)] == ')';
+}
+
+uint32_t
+LazyDocument::skip(uint32_t idx) const
+{
+  if (is_open(idx))
+  {
+    return m_match[idx] + 1;
+  }
+  else if (is_array_start(idx))
+  {
+    return m_match[idx + 1] + 1;
+  }
+  else
+  {
+    return idx + 1;
+  }
+}
+
+LazyValue
+LazyDocument::make_tail(uint32_t idx) const
+{
+  if (is_end(idx))
+  {
+    return LazyValue();
+  }
+  else if (is_dot(idx))
+  {
+    return LazyValue(this, idx + 1, LazyValue::ELEMENT);
+  }
+  else
+  {
+    return LazyValue(this, idx, LazyValue::TAIL);
+  }
+}
+
+Value
+LazyDocument::parse_element(uint32_t idx) const
+{
+  std::vector<uint32_t> const& starts = m_index->get_starts();
+  if (idx >= starts.size())
+  {
+    parse_error(m_text.size(), "Unexpected EOF.");
+  }
+
+  // lists end at their ')', atoms get everything up to the next token
+  // to see the same look-ahead as when parsing the whole document
+  size_t const begin = starts[idx];
+  size_t end;
+  if (is_open(idx) || is_array_start(idx))
+  {
+    end = starts[skip(idx) - 1] + 1;
+  }
+  else if (idx + 1 < starts.size())
+  {
+    end = starts[idx + 1];
+  }
+  else
+  {
+    end = m_text.size();
+  }
+
+  Lexer lexer(m_text.substr(begin, end - begin), m_use_arrays, m_index->newlines_before(begin));
+  Parser parser(lexer);
+  return parser.read();
+}
+
+Value const&
+LazyDocument::materialize(LazyValue const& value) const
+{
+  if (value.m_kind == LazyValue::NIL)
+  {
+    return Value::nil_ref();
+  }
+
+  uint64_t const key = (static_cast<uint64_t>(value.m_idx) << 1) | (value.m_kind == LazyValue::TAIL ? 1 : 0);
+  auto it = m_cache.find(key);
+  if (it != m_cache.end())
+  {
+    return it->second;
+  }
+
+  Value result;
+  if (value.m_kind == LazyValue::ELEMENT)
+  {
+    result = parse_element(value.m_idx);
+  }
+  else
+  {
+    std::vector<Value> items;
+    uint32_t idx = value.m_idx;
+    while(!is_end(idx))
+    {
+      if (is_dot(idx))
+      {
+        result = parse_element(idx + 1);
+        break;
+      }
+      items.push_back(parse_element(idx));
+      idx = skip(idx);
+    }
+
+    for(auto item = items.rbegin(); item != items.rend(); ++item)
+    {
+      result = Value::cons(std::move(*item), std::move(result));
+    }
+  }
+
+  return m_cache.emplace(key, std::move(result)).first->second;
+}
+
+bool
+LazyValue::is_nil() const
+{
+  if (m_kind == NIL)
+  {
+    return true;
+  }
+  else if (m_kind == ELEMENT)
+  {
+    return (m_doc->is_open(m_idx) && !m_doc->m_use_arrays &&
+            m_doc->m_match[m_idx] == m_idx + 1);
+  }
+  else
+  {
+    return false;
+  }
+}
+
+bool
+LazyValue::is_cons() const
+{
+  if (m_kind == TAIL)
+  {
+    return true;
+  }
+  else if (m_kind == ELEMENT)
+  {
+    return (m_doc->is_open(m_idx) && !m_doc->m_use_arrays &&
+            m_doc->m_match[m_idx] != m_idx + 1);
+  }
+  else
+  {
+    return false;
+  }
+}
+
+bool
+LazyValue::is_array() const
+{
+  return m_kind == ELEMENT && m_doc->is_array_start(m_idx);
+}
+
+bool
+LazyValue::is_atom() const
+{
+  return m_kind == ELEMENT && !m_doc->is_open(m_idx) && !m_doc->is_array_start(m_idx);
+}
+
+void
+LazyValue::type_error(const char* msg) const
+{
+  int const line = m_doc ? m_doc->m_index->newlines_before(m_doc->offset(m_idx)) : 0;
+  throw TypeError(line, msg);
+}
+
+LazyValue
+LazyValue::get_car() const
+{
+  if (!is_cons())
+  {
+    type_error("sexp::LazyValue::get_car(): wrong type, expected Type::CONS");
+  }
+  else if (m_kind == TAIL)
+  {
+    return LazyValue(m_doc, m_idx, ELEMENT);
+  }
+  else
+  {
+    return LazyValue(m_doc, m_idx + 1, ELEMENT);
+  }
+}
+
+LazyValue
+LazyValue::get_cdr() const
+{
+  if (!is_cons())
+  {
+    type_error("sexp::LazyValue::get_cdr(): wrong type, expected Type::CONS");
+  }
+  else if (m_kind == TAIL)
+  {
+    return m_doc->make_tail(m_doc->skip(m_idx));
+  }
+  else
+  {
+    return m_doc->make_tail(m_doc->skip(m_idx + 1));
+  }
+}
+
+Value const&
+LazyValue::get() const
+{
+  if (m_kind == NIL)
+  {
+    return Value::nil_ref();
+  }
+  else
+  {
+    return m_doc->materialize(*this);
+  }
+}
+
+bool
+LazyValue::is_symbol(std::string_view name) const
+{
+  if (!is_atom())
+  {
+    return false;
+  }
+
+  // compare the raw text first to not build Values for every key that
+  // doesn't match
+  std::string_view const text = m_doc->m_text.substr(m_doc->offset(m_idx));
+  if (text.substr(0, name.size()) != name ||
+      (text.size() > name.size() && !is_delimiter(text[name.size()])))
+  {
+    return false;
+  }
+  else
+  {
+    return get().is_symbol();
+  }
+}
+
+LazyValue
+assoc_ref(LazyValue const& sx, std::string_view key)
+{
+  LazyValue cur = sx;
+  while(cur.is_cons())
+  {
+    LazyValue const pair = cur.get_car();
+    if (pair.is_cons() && pair.get_car().is_symbol(key))
+    {
+      return pair.get_cdr();
+    }
+    cur = cur.get_cdr();
+  }
+
+  if (!cur.is_nil())
+  {
+    std::ostringstream msg;
+    msg << "malformed input to sexp::assoc_ref(): key:\"" << key << "\"";
+    throw std::runtime_error(msg.str());
+  }
+  return LazyValue();
+}
+
+} // namespace sexp
+
+/* EOF */
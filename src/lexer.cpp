@@ -17,34 +17,209 @@
 
 #include "sexp/lexer.hpp"
 
-#include <assert.h>
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <stdint.h>
 #include <string.h>
 #include <sstream>
 #include <stdexcept>
 #include <stdio.h>
 
+#include "char_class.hpp"
+#include "float.hpp"
+#include "simd.hpp"
+#include "structural_index.hpp"
+
 namespace sexp {
 
-Lexer::Lexer(std::istream& newstream, bool use_arrays) :
-  m_stream(newstream),
+namespace {
+
+/** Number of '\n' in [begin, end) */
+int count_newlines(char const* begin, char const* end)
+{
+  int count = 0;
+#ifdef SEXP_HAVE_SSE2
+  for(; end - begin >= 16; begin += 16)
+  {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(begin)); // NOLINT
+    unsigned const mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+    count += std::popcount(mask);
+  }
+#endif
+
+  for(; begin < end; ++begin) {
+    count += (*begin == '\n');
+  }
+  return count;
+}
+
+/** States of the recognizer for numbers, named after the input seen
+    so far. Tokens that don't end in a number state are symbols. */
+enum NumberState : uint8_t
+{
+  STATE_INIT,
+  STATE_SYMBOL,
+  STATE_DOT,            // "."
+  STATE_SIGN,           // "-"
+  STATE_SIGN_POINT,     // "-."
+  STATE_INTEGER,        // "-12"
+  STATE_INTEGER_POINT,  // "12."
+  STATE_FRACTION,       // "12.5", ".5"
+  STATE_EXPONENT_MARK,  // "12e"
+  STATE_EXPONENT_SIGN,  // "12e-"
+  STATE_EXPONENT,       // "12e-3"
+  STATE_COUNT
+};
+
+/** Next state indexed by state and the CHAR_NUMBER_MASK part of the
+    character class: other, digit, sign, point, exponent */
+constexpr NumberState number_transitions[STATE_COUNT][5] = {
+  /* INIT */           { STATE_SYMBOL, STATE_INTEGER, STATE_SIGN, STATE_DOT, STATE_SYMBOL },
+  /* SYMBOL */         { STATE_SYMBOL, STATE_SYMBOL, STATE_SYMBOL, STATE_SYMBOL, STATE_SYMBOL },
+  /* DOT */            { STATE_SYMBOL, STATE_FRACTION, STATE_SYMBOL, STATE_SYMBOL, STATE_SYMBOL },
+  /* SIGN */           { STATE_SYMBOL, STATE_INTEGER, STATE_SYMBOL, STATE_SIGN_POINT, STATE_SYMBOL },
+  /* SIGN_POINT */     { STATE_SYMBOL, STATE_FRACTION, STATE_SYMBOL, STATE_SYMBOL, STATE_SYMBOL },
+  /* INTEGER */        { STATE_SYMBOL, STATE_INTEGER, STATE_SYMBOL, STATE_INTEGER_POINT, STATE_EXPONENT_MARK },
+  /* INTEGER_POINT */  { STATE_SYMBOL, STATE_FRACTION, STATE_SYMBOL, STATE_SYMBOL, STATE_SYMBOL },
+  /* FRACTION */       { STATE_SYMBOL, STATE_FRACTION, STATE_SYMBOL, STATE_SYMBOL, STATE_EXPONENT_MARK },
+  /* EXPONENT_MARK */  { STATE_SYMBOL, STATE_EXPONENT, STATE_EXPONENT_SIGN, STATE_SYMBOL, STATE_SYMBOL },
+  /* EXPONENT_SIGN */  { STATE_SYMBOL, STATE_EXPONENT, STATE_SYMBOL, STATE_SYMBOL, STATE_SYMBOL },
+  /* EXPONENT */       { STATE_SYMBOL, STATE_EXPONENT, STATE_SYMBOL, STATE_SYMBOL, STATE_SYMBOL },
+};
+
+/** Token type of the input that ended in a given state */
+constexpr Lexer::TokenType number_tokens[STATE_COUNT] = {
+  /* INIT */           Lexer::TOKEN_SYMBOL,
+  /* SYMBOL */         Lexer::TOKEN_SYMBOL,
+  /* DOT */            Lexer::TOKEN_DOT,
+  /* SIGN */           Lexer::TOKEN_SYMBOL,
+  /* SIGN_POINT */     Lexer::TOKEN_SYMBOL,
+  /* INTEGER */        Lexer::TOKEN_INTEGER,
+  /* INTEGER_POINT */  Lexer::TOKEN_REAL,
+  /* FRACTION */       Lexer::TOKEN_REAL,
+  /* EXPONENT_MARK */  Lexer::TOKEN_SYMBOL,
+  /* EXPONENT_SIGN */  Lexer::TOKEN_SYMBOL,
+  /* EXPONENT */       Lexer::TOKEN_REAL,
+};
+
+inline bool is_token_end(int c)
+{
+  return c == EOF || (char_class(c) & CHAR_TOKEN_END) != 0;
+}
+
+} // namespace
+
+Lexer::Lexer(std::istream& newstream, bool use_arrays, size_t buffer_size) :
+  m_stream(nullptr),
   m_use_arrays(use_arrays),
   m_eof(false),
   m_linenumber(0),
+  m_line_pos(nullptr),
+  m_buffer(),
+  m_buffer_size(std::max<size_t>(buffer_size, 1)),
+  m_bufend(),
+  m_bufpos(),
+  m_c(),
+  m_token_string(),
+  m_token_view(),
+  m_integer(0),
+  m_integer_overflow(false),
+  m_begin(nullptr),
+  m_index(),
+  m_index_pos(0)
+{
+  reset(newstream);
+}
+
+Lexer::Lexer(std::string_view text, bool use_arrays, int first_line) :
+  m_stream(nullptr),
+  m_use_arrays(use_arrays),
+  m_eof(true),
+  m_linenumber(0),
+  m_line_pos(nullptr),
+  m_buffer(),
+  m_buffer_size(DEFAULT_BUFFER_SIZE),
   m_bufend(),
   m_bufpos(),
   m_c(),
-  m_token_string()
+  m_token_string(),
+  m_token_view(),
+  m_integer(0),
+  m_integer_overflow(false),
+  m_begin(nullptr),
+  m_index(),
+  m_index_pos(0)
+{
+  reset(text, first_line);
+}
+
+void
+Lexer::set_buffer_size(size_t size)
 {
+  m_buffer_size = std::max<size_t>(size, 1);
+}
+
+void
+Lexer::reset(std::istream& newstream)
+{
+  if (!m_buffer) {
+    m_buffer = std::make_unique_for_overwrite<char[]>(m_buffer_size + 1);
+  }
+
+  m_stream = &newstream;
+  m_eof = false;
+  m_linenumber = 0;
+  m_line_pos = nullptr;
+  m_token_string.clear();
+  m_token_view = {};
+  m_integer = 0;
+  m_integer_overflow = false;
+  m_begin = nullptr;
+  m_index.reset();
+  m_index_pos = 0;
+
   // trigger a refill of the buffer
   m_bufpos = nullptr;
   m_bufend = nullptr;
   next_char();
 }
 
+void
+Lexer::reset(std::string_view text, int first_line)
+{
+  m_stream = nullptr;
+  m_eof = true;
+  m_linenumber = first_line;
+  m_line_pos = text.data();
+  m_bufend = const_cast<char*>(text.data() + text.size()); // NOLINT
+  m_bufpos = const_cast<char*>(text.data()); // NOLINT
+  m_token_string.clear();
+  m_token_view = {};
+  m_integer = 0;
+  m_integer_overflow = false;
+  m_begin = text.data();
+  m_index.reset();
+  m_index_pos = 0;
+
+  if (text.size() >= STRUCTURAL_INDEX_THRESHOLD &&
+      text.size() <= UINT32_MAX &&
+      is_worth_indexing(text)) {
+    m_index = std::make_unique<StructuralIndex>(text);
+  }
+  next_char();
+}
+
 Lexer::~Lexer()
 {
 }
 
+float
+Lexer::get_real() const
+{
+  return string2float(m_token_view);
+}
+
 void
 Lexer::next_char()
 {
@@ -53,16 +228,18 @@ Lexer::next_char()
       m_c = EOF;
       return;
     }
-    m_stream.read(m_buffer, BUFFER_SIZE);
-    std::streamsize bytes_read = m_stream.gcount();
+    count_lines();
+    m_stream->read(m_buffer.get(), static_cast<std::streamsize>(m_buffer_size));
+    std::streamsize bytes_read = m_stream->gcount();
 
-    m_bufpos = m_buffer;
-    m_bufend = m_buffer + bytes_read;
+    m_bufpos = m_buffer.get();
+    m_bufend = m_buffer.get() + bytes_read;
+    m_line_pos = m_buffer.get();
 
     // the following is a hack that appends an additional ' ' at the end of
     // the file to avoid problems when parsing symbols/elements and a sudden
     // EOF. This is faster than relying on unget and IMO also nicer.
-    if (bytes_read == 0 || m_stream.eof()) {
+    if (bytes_read == 0 || m_stream->eof()) {
       m_eof = true;
       *m_bufend = ' ';
       ++m_bufend;
@@ -74,33 +251,88 @@ Lexer::next_char()
   }
 
   m_c = static_cast<unsigned char>(*m_bufpos++);
-  if (m_c == '\n') {
-    ++m_linenumber;
-  }
+}
+
+void
+Lexer::count_lines() const
+{
+  m_linenumber += count_newlines(m_line_pos, m_bufpos);
+  m_line_pos = m_bufpos;
 }
 
 void
 Lexer::add_char()
 {
-  m_token_string += static_cast<char>(m_c);
+  // in-memory tokens are sliced out of the source instead of copied
+  if (m_stream) {
+    m_token_string += static_cast<char>(m_c);
+  }
+  next_char();
+}
+
+char const*
+Lexer::current() const
+{
+  return m_c == EOF ? m_bufend : m_bufpos - 1;
+}
+
+void
+Lexer::finish_token(char const* start)
+{
+  if (m_stream) {
+    m_token_view = m_token_string;
+  } else {
+    m_token_view = std::string_view(start, static_cast<size_t>(current() - start));
+  }
+}
+
+void
+Lexer::skip_blank()
+{
+  // a single space between tokens is cheaper to step over than to
+  // look up, only longer runs of whitespace and comments are skipped
+  // with the index
+  if (is_space(m_c)) {
+    next_char();
+  }
+
+  if (!is_space(m_c) && m_c != ';') {
+    return;
+  }
+
+  // jump straight to the next token start
+  std::vector<uint32_t> const& starts = m_index->get_starts();
+  size_t const pos = static_cast<size_t>(current() - m_begin);
+  while (m_index_pos < starts.size() && starts[m_index_pos] < pos) {
+    ++m_index_pos;
+  }
+
+  char const* target = (m_index_pos < starts.size()) ? m_begin + starts[m_index_pos] : m_bufend;
+  m_bufpos = const_cast<char*>(target); // NOLINT
   next_char();
 }
 
 Lexer::TokenType
 Lexer::get_next_token()
 {
-  static const char* delims = "\"();";
+  if (m_index) {
+    skip_blank();
+  }
 
-  while(isspace(m_c)) {
+  while(is_space(m_c)) {
     next_char();
   }
 
   m_token_string.clear();
+  m_token_view = std::string_view();
 
   switch(m_c)
   {
     case ';': // comment
-      while(m_c != '\n') {
+      while(m_c != '\n' && m_c != EOF) {
+        // skip the rest of the buffer or line in one go
+        void const* eol = memchr(m_bufpos, '\n', static_cast<size_t>(m_bufend - m_bufpos));
+        m_bufpos = eol ? static_cast<char*>(const_cast<void*>(eol)) : m_bufend; // NOLINT
         next_char();
       }
       return get_next_token(); // and again
@@ -120,18 +352,39 @@ Lexer::get_next_token()
       return TOKEN_CLOSE_PAREN;
 
     case '"': {  // string
-      int startline = m_linenumber;
+      int startline = get_line_number();
+      // in-memory strings without escapes are returned as slice of
+      // the source, everything else gets copied into m_token_string
+      bool copy = (m_stream != nullptr);
+      char const* start = m_bufpos;
       while(1) {
+        // step over the run of plain characters up to the next one
+        // that needs a closer look
+        char* const run_end = const_cast<char*>(find_any(m_bufpos, m_bufend, '"', '\\', '\r', '\n')); // NOLINT
+        if (copy) {
+          m_token_string.append(m_bufpos, run_end);
+        }
+        m_bufpos = run_end;
+
         next_char();
         switch(m_c) {
           case '"':
+            if (copy) {
+              m_token_view = m_token_string;
+            } else {
+              m_token_view = std::string_view(start, static_cast<size_t>(current() - start));
+            }
             next_char();
             goto string_finished;
           case '\r':
-            continue;
-          case '\n':
-            break;
           case '\\':
+            if (!copy) {
+              m_token_string.assign(start, current());
+              copy = true;
+            }
+            if (m_c == '\r') {
+              continue;
+            }
             next_char();
             switch(m_c) {
               case 'n':
@@ -142,6 +395,8 @@ Lexer::get_next_token()
                 break;
             }
             break;
+          case '\n':
+            break;
           case EOF: {
             std::stringstream msg;
             msg << "Parse error in line " << startline << ": "
@@ -151,7 +406,9 @@ Lexer::get_next_token()
           default:
             break;
         }
-        m_token_string += static_cast<char>(m_c);
+        if (copy) {
+          m_token_string += static_cast<char>(m_c);
+        }
       }
       string_finished:
       return TOKEN_STRING;
@@ -166,15 +423,17 @@ Lexer::get_next_token()
       }
       else
       {
-        while(isalnum(m_c) || m_c == '_') {
+        char const* start = current();
+        while(char_class(m_c) & CHAR_IDENTIFIER) {
           add_char();
         }
+        finish_token(start);
 
-        if (m_token_string == "t")
+        if (m_token_view == "t")
         {
           return TOKEN_TRUE;
         }
-        else if (m_token_string == "f")
+        else if (m_token_view == "f")
         {
           return TOKEN_FALSE;
         }
@@ -182,8 +441,8 @@ Lexer::get_next_token()
         {
           // we only handle #t and #f constants at the moment...
           std::stringstream msg;
-          msg << "Parse Error in line " << m_linenumber << ": "
-              << "Unknown constant '" << m_token_string << "'.";
+          msg << "Parse Error in line " << get_line_number() << ": "
+              << "Unknown constant '" << m_token_view << "'.";
           throw std::runtime_error(msg.str());
         }
       }
@@ -193,159 +452,41 @@ Lexer::get_next_token()
 
     default:
       {
-        enum {
-          STATE_INIT,
-          STATE_SYMBOL,
-          STATE_MAYBE_DOT,
-          STATE_MAYBE_INTEGER_SIGN,
-          STATE_MAYBE_INTEGER_PART,
-          STATE_MAYBE_FRACTIONAL_START,
-          STATE_MAYBE_FRACTIONAL_PART,
-          STATE_MAYBE_EXPONENT_SIGN,
-          STATE_MAYBE_EXPONENT_START,
-          STATE_MAYBE_EXPONENT_PART,
-        } state = STATE_INIT;
-
-        bool has_integer_part = false;
-        bool has_fractional_part = false;
+        char const* start = current();
+        bool const negative = (m_c == '-');
+        bool overflow = false;
+        uint32_t magnitude = 0;
+        NumberState state = STATE_INIT;
         do
         {
-          switch(state)
-          {
-            case STATE_INIT:
-              if (isdigit(m_c)) {
-                has_integer_part = true;
-                state = STATE_MAYBE_INTEGER_PART;
-              } else if (m_c == '-' || m_c == '+') {
-                state = STATE_MAYBE_INTEGER_SIGN;
-              } else if (m_c == '.') {
-                state = STATE_MAYBE_DOT;
-              } else {
-                state = STATE_SYMBOL;
-              }
-              break;
-
-            case STATE_SYMBOL:
-              break;
-
-            case STATE_MAYBE_DOT:
-              if (isdigit(m_c)) {
-                state = STATE_MAYBE_FRACTIONAL_START;
-              } else {
-                state = STATE_SYMBOL;
-              }
-              break;
-
-            case STATE_MAYBE_INTEGER_SIGN:
-              if (isdigit(m_c)) {
-                has_integer_part = true;
-                state = STATE_MAYBE_INTEGER_PART;
-              } else if (m_c == '.') {
-                state = STATE_MAYBE_FRACTIONAL_START;
-              }
-              break;
-
-            case STATE_MAYBE_INTEGER_PART:
-              if (isdigit(m_c)) {
-                // loop
-              } else if (m_c == '.') {
-                state = STATE_MAYBE_FRACTIONAL_START;
-              } else if (m_c == 'e' || m_c == 'E') {
-                state = STATE_MAYBE_EXPONENT_SIGN;
-              } else {
-                state = STATE_SYMBOL;
-              }
-              break;
-
-            case STATE_MAYBE_FRACTIONAL_START:
-              if (isdigit(m_c)) {
-                has_fractional_part = true;
-                state = STATE_MAYBE_FRACTIONAL_PART;
-              } else {
-                state = STATE_SYMBOL;
-              }
-              break;
-
-            case STATE_MAYBE_FRACTIONAL_PART:
-              if (isdigit(m_c)) {
-                // loop
-              } else if ((has_integer_part || has_fractional_part) &&
-                         (m_c == 'e' || m_c == 'E')) {
-                state = STATE_MAYBE_EXPONENT_SIGN;
-              } else {
-                state = STATE_SYMBOL;
-              }
-              break;
-
-            case STATE_MAYBE_EXPONENT_SIGN:
-              if (m_c == '-' || m_c == '+') {
-                state = STATE_MAYBE_EXPONENT_START;
-              } else if (isdigit(m_c)) {
-                state = STATE_MAYBE_EXPONENT_PART;
-              } else {
-                state = STATE_SYMBOL;
-              }
-              break;
-
-            case STATE_MAYBE_EXPONENT_START:
-              if (isdigit(m_c)) {
-                state = STATE_MAYBE_EXPONENT_PART;
-              } else {
-                state = STATE_SYMBOL;
-              }
-              break;
-
-            case STATE_MAYBE_EXPONENT_PART:
-              if (isdigit(m_c)) {
-                // loop
-              } else {
-                state = STATE_SYMBOL;
-              }
-              break;
+          state = number_transitions[state][char_class(m_c) & CHAR_NUMBER_MASK];
+          if (state == STATE_INTEGER) {
+            // once the magnitude is beyond this it no longer fits
+            // into an int and the digits can be ignored
+            if (magnitude <= (std::numeric_limits<uint32_t>::max() - 9) / 10) {
+              magnitude = magnitude * 10 + static_cast<uint32_t>(m_c - '0');
+            } else {
+              overflow = true;
+            }
+          } else if (state == STATE_SYMBOL) {
+            // nothing turns a symbol back into a number
+            do {
+              add_char();
+            } while(!is_token_end(m_c));
+            break;
           }
-
           add_char();
         }
-        while(!isspace(m_c) && !strchr(delims, m_c));
+        while(!is_token_end(m_c));
+        finish_token(start);
 
-        switch(state)
-        {
-          case STATE_INIT:
-            assert(false && "never reached");
-            return TOKEN_EOF;
-
-          case STATE_SYMBOL:
-            return TOKEN_SYMBOL;
-
-          case STATE_MAYBE_DOT:
-            return TOKEN_DOT;
-
-          case STATE_MAYBE_INTEGER_SIGN:
-            return TOKEN_SYMBOL;
-
-          case STATE_MAYBE_INTEGER_PART:
-            return TOKEN_INTEGER;
-
-          case STATE_MAYBE_FRACTIONAL_START:
-            if (has_integer_part) {
-              return TOKEN_REAL;
-            } else {
-              return TOKEN_SYMBOL;
-            }
-
-          case STATE_MAYBE_FRACTIONAL_PART:
-            return TOKEN_REAL;
-
-          case STATE_MAYBE_EXPONENT_SIGN:
-          case STATE_MAYBE_EXPONENT_START:
-            return TOKEN_SYMBOL;
-
-          case STATE_MAYBE_EXPONENT_PART:
-            return TOKEN_REAL;
+        if (state == STATE_INTEGER) {
+          uint32_t const limit = static_cast<uint32_t>(std::numeric_limits<int>::max()) + (negative ? 1 : 0);
+          m_integer_overflow = overflow || magnitude > limit;
+          m_integer = static_cast<int>(negative ? 0 - static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude));
         }
+        return number_tokens[state];
       }
-      assert(false && "never reached");
-      return TOKEN_EOF;
   }
 }
 
@@ -0,0 +1,68 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "mapped_file.hpp"
+
+#if !defined(_WIN32)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace sexp {
+
+MappedFile::MappedFile(std::string const& filename) :
+  m_data(nullptr),
+  m_size(0)
+{
+#if !defined(_WIN32)
+  int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+  {
+    size_t const size = static_cast<size_t>(st.st_size);
+    void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) // NOLINT
+    {
+#  if defined(MADV_SEQUENTIAL)
+      ::madvise(addr, size, MADV_SEQUENTIAL);
+#  endif
+      m_data = static_cast<char const*>(addr);
+      m_size = size;
+    }
+  }
+
+  ::close(fd);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#if !defined(_WIN32)
+  if (m_data) {
+    ::munmap(const_cast<char*>(m_data), m_size); // NOLINT
+  }
+#endif
+}
+
+} // namespace sexp
+
+/* EOF */
@@ -0,0 +1,51 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_MAPPED_FILE_HPP
+#define HEADER_SEXP_MAPPED_FILE_HPP
+
+#include <string>
+#include <string_view>
+
+namespace sexp {
+
+/** Read-only memory mapping of a regular file. Mapping fails silently
+    for pipes, devices and other non-regular files as well as on
+    platforms without mmap(), is_mapped() will return false in that
+    case and the caller is expected to fall back to buffered reads. */
+class MappedFile
+{
+public:
+  MappedFile(std::string const& filename);
+  ~MappedFile();
+
+  bool is_mapped() const { return m_data != nullptr; }
+  std::string_view get_data() const { return std::string_view(m_data, m_size); }
+
+private:
+  char const* m_data;
+  size_t m_size;
+
+private:
+  MappedFile(const MappedFile&);
+  MappedFile & operator=(const MappedFile&);
+};
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
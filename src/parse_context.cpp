@@ -0,0 +1,91 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sexp/parse_context.hpp"
+
+namespace sexp {
+
+ParseContext::ParseContext(bool use_arrays, size_t buffer_size) :
+  m_lexer(std::string_view(), use_arrays),
+  m_parser(m_lexer)
+{
+  m_lexer.set_buffer_size(buffer_size);
+}
+
+ParseContext::ParseContext(Arena& arena, bool use_arrays, size_t buffer_size) :
+  m_lexer(std::string_view(), use_arrays),
+  m_parser(m_lexer, arena)
+{
+  m_lexer.set_buffer_size(buffer_size);
+}
+
+ParseContext::ParseContext(std::pmr::memory_resource& resource, bool use_arrays, size_t buffer_size) :
+  m_lexer(std::string_view(), use_arrays),
+  m_parser(m_lexer, resource)
+{
+  m_lexer.set_buffer_size(buffer_size);
+}
+
+ParseContext::~ParseContext()
+{
+}
+
+Value
+ParseContext::from_string_view(std::string_view str)
+{
+  m_lexer.reset(str);
+  m_parser.reset();
+  return read_one();
+}
+
+Value
+ParseContext::from_stream(std::istream& stream)
+{
+  m_lexer.reset(stream);
+  m_parser.reset();
+  return read_one();
+}
+
+std::vector<Value>
+ParseContext::from_string_view_many(std::string_view str)
+{
+  m_lexer.reset(str);
+  m_parser.reset();
+  return m_parser.read_many();
+}
+
+std::vector<Value>
+ParseContext::from_stream_many(std::istream& stream)
+{
+  m_lexer.reset(stream);
+  m_parser.reset();
+  return m_parser.read_many();
+}
+
+Value
+ParseContext::read_one()
+{
+  Value result = m_parser.read();
+  if (!m_parser.eof())
+  {
+    m_parser.parse_error("trailing garbage in stream");
+  }
+  return result;
+}
+
+} // namespace sexp
+
+/* EOF */
@@ -17,27 +17,302 @@
 
 #include "sexp/parser.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iterator>
 #include <sstream>
 #include <stdexcept>
 #include <string.h>
+#include <system_error>
+#include <thread>
 #include <iostream>
 
-#include "float.hpp"
+#include "mapped_file.hpp"
+#include "structural_index.hpp"
 
 namespace sexp {
 
 Value
 Parser::from_string(std::string const& str, bool use_arrays)
 {
-  std::istringstream is(str);
-  return from_stream(is);
+  return from_string_view(str, use_arrays);
+}
+
+Value
+Parser::from_string_view(std::string_view str, bool use_arrays)
+{
+  Lexer lexer(str, use_arrays);
+  return read_one(lexer, {});
 }
 
 Value
 Parser::from_stream(std::istream& stream, bool use_arrays)
 {
   Lexer lexer(stream, use_arrays);
+  return read_one(lexer, {});
+}
+
+std::vector<Value>
+Parser::from_string_many(std::string const& str, bool use_arrays)
+{
+  return from_string_view_many(str, use_arrays);
+}
+
+std::vector<Value>
+Parser::from_string_view_many(std::string_view str, bool use_arrays)
+{
+  Lexer lexer(str, use_arrays);
+  return read_all(lexer, {});
+}
+
+std::vector<Value>
+Parser::from_stream_many(std::istream& stream, bool use_arrays)
+{
+  Lexer lexer(stream, use_arrays);
+  return read_all(lexer, {});
+}
+
+Value
+Parser::from_file(std::string const& filename, bool use_arrays)
+{
+  return read_file(filename, {}, use_arrays);
+}
+
+std::vector<Value>
+Parser::from_file_many(std::string const& filename, bool use_arrays)
+{
+  return read_file_many(filename, {}, use_arrays);
+}
+
+FormRange
+Parser::forms(std::istream& stream, bool use_arrays)
+{
+  return FormRange(stream, use_arrays);
+}
+
+FormRange
+Parser::forms(std::string_view str, bool use_arrays)
+{
+  return FormRange(str, use_arrays);
+}
+
+std::vector<Value>
+Parser::from_string_view_many_parallel(std::string_view str, bool use_arrays, unsigned num_threads)
+{
+  if (num_threads == 0)
+  {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  if (num_threads == 1 || str.size() < PARALLEL_THRESHOLD)
+  {
+    return from_string_view_many(str, use_arrays);
+  }
+
+  // a few pieces per thread to even out differences in parse speed
+  size_t const chunk_size = std::max(PARALLEL_MIN_CHUNK_SIZE, str.size() / (num_threads * 4));
+  std::vector<FormBoundary> const pieces = split_top_level(str, chunk_size);
+  if (pieces.size() == 1)
+  {
+    return from_string_view_many(str, use_arrays);
+  }
+
+  std::vector<std::vector<Value> > results(pieces.size());
+  std::atomic<size_t> next_piece(0);
+  std::atomic<bool> failed(false);
+  auto const worker = [&]{
+    while(!failed)
+    {
+      size_t const idx = next_piece++;
+      if (idx >= pieces.size())
+      {
+        break;
+      }
+
+      size_t const end = idx + 1 < pieces.size() ? pieces[idx + 1].offset : str.size();
+      try
+      {
+        Lexer lexer(str.substr(pieces[idx].offset, end - pieces[idx].offset), use_arrays, pieces[idx].line);
+        results[idx] = read_all(lexer, {});
+      }
+      catch(...)
+      {
+        failed = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  try
+  {
+    for(unsigned i = 1; i < std::min(num_threads, static_cast<unsigned>(pieces.size())); ++i)
+    {
+      threads.emplace_back(worker);
+    }
+  }
+  catch(std::system_error const&)
+  {
+    // continue with the threads we got
+  }
+  worker();
+  for(auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  if (failed)
+  {
+    // parse again to report the error the same way as the serial
+    // parser, with the right line number and the right form
+    return from_string_view_many(str, use_arrays);
+  }
+
+  size_t total = 0;
+  for(auto const& result : results)
+  {
+    total += result.size();
+  }
+
+  std::vector<Value> values;
+  values.reserve(total);
+  for(auto& result : results)
+  {
+    std::move(result.begin(), result.end(), std::back_inserter(values));
+  }
+  return values;
+}
+
+std::vector<Value>
+Parser::from_file_many_parallel(std::string const& filename, bool use_arrays, unsigned num_threads)
+{
+  MappedFile file(filename);
+  if (file.is_mapped())
+  {
+    return from_string_view_many_parallel(file.get_data(), use_arrays, num_threads);
+  }
+  else
+  {
+    std::ifstream fin(filename, std::ios::binary);
+    if (!fin)
+    {
+      throw std::runtime_error("failed to open " + filename);
+    }
+    std::string const text((std::istreambuf_iterator<char>(fin)),
+                           std::istreambuf_iterator<char>());
+    return from_string_view_many_parallel(text, use_arrays, num_threads);
+  }
+}
+
+Value
+Parser::from_string(std::string const& str, Arena& arena, bool use_arrays)
+{
+  return from_string_view(str, arena, use_arrays);
+}
+
+Value
+Parser::from_string_view(std::string_view str, Arena& arena, bool use_arrays)
+{
+  Lexer lexer(str, use_arrays);
+  return read_one(lexer, {&arena, nullptr});
+}
+
+Value
+Parser::from_stream(std::istream& stream, Arena& arena, bool use_arrays)
+{
+  Lexer lexer(stream, use_arrays);
+  return read_one(lexer, {&arena, nullptr});
+}
+
+Value
+Parser::from_file(std::string const& filename, Arena& arena, bool use_arrays)
+{
+  return read_file(filename, {&arena, nullptr}, use_arrays);
+}
+
+std::vector<Value>
+Parser::from_string_many(std::string const& str, Arena& arena, bool use_arrays)
+{
+  return from_string_view_many(str, arena, use_arrays);
+}
+
+std::vector<Value>
+Parser::from_string_view_many(std::string_view str, Arena& arena, bool use_arrays)
+{
+  Lexer lexer(str, use_arrays);
+  return read_all(lexer, {&arena, nullptr});
+}
+
+std::vector<Value>
+Parser::from_stream_many(std::istream& stream, Arena& arena, bool use_arrays)
+{
+  Lexer lexer(stream, use_arrays);
+  return read_all(lexer, {&arena, nullptr});
+}
+
+std::vector<Value>
+Parser::from_file_many(std::string const& filename, Arena& arena, bool use_arrays)
+{
+  return read_file_many(filename, {&arena, nullptr}, use_arrays);
+}
+
+Value
+Parser::from_string(std::string const& str, std::pmr::memory_resource& resource, bool use_arrays)
+{
+  return from_string_view(str, resource, use_arrays);
+}
+
+Value
+Parser::from_string_view(std::string_view str, std::pmr::memory_resource& resource, bool use_arrays)
+{
+  Lexer lexer(str, use_arrays);
+  return read_one(lexer, {nullptr, &resource});
+}
+
+Value
+Parser::from_stream(std::istream& stream, std::pmr::memory_resource& resource, bool use_arrays)
+{
+  Lexer lexer(stream, use_arrays);
+  return read_one(lexer, {nullptr, &resource});
+}
+
+Value
+Parser::from_file(std::string const& filename, std::pmr::memory_resource& resource, bool use_arrays)
+{
+  return read_file(filename, {nullptr, &resource}, use_arrays);
+}
+
+std::vector<Value>
+Parser::from_string_many(std::string const& str, std::pmr::memory_resource& resource, bool use_arrays)
+{
+  return from_string_view_many(str, resource, use_arrays);
+}
+
+std::vector<Value>
+Parser::from_string_view_many(std::string_view str, std::pmr::memory_resource& resource, bool use_arrays)
+{
+  Lexer lexer(str, use_arrays);
+  return read_all(lexer, {nullptr, &resource});
+}
+
+std::vector<Value>
+Parser::from_stream_many(std::istream& stream, std::pmr::memory_resource& resource, bool use_arrays)
+{
+  Lexer lexer(stream, use_arrays);
+  return read_all(lexer, {nullptr, &resource});
+}
+
+std::vector<Value>
+Parser::from_file_many(std::string const& filename, std::pmr::memory_resource& resource, bool use_arrays)
+{
+  return read_file_many(filename, {nullptr, &resource}, use_arrays);
+}
+
+Value
+Parser::read_one(Lexer& lexer, Allocator alloc)
+{
   Parser parser(lexer);
+  parser.m_alloc = alloc;
   Value result = parser.read();
   if (parser.m_token != Lexer::TOKEN_EOF)
   {
@@ -47,23 +322,111 @@ Parser::from_stream(std::istream& stream, bool use_arrays)
 }
 
 std::vector<Value>
-Parser::from_string_many(std::string const& str, bool use_arrays)
+Parser::read_all(Lexer& lexer, Allocator alloc)
 {
-  std::istringstream is(str);
-  return from_stream_many(is);
+  Parser parser(lexer);
+  parser.m_alloc = alloc;
+  return parser.read_many();
+}
+
+Value
+Parser::read_file(std::string const& filename, Allocator alloc, bool use_arrays)
+{
+  MappedFile file(filename);
+  if (file.is_mapped())
+  {
+    Lexer lexer(file.get_data(), use_arrays);
+    return read_one(lexer, alloc);
+  }
+  else
+  {
+    std::ifstream fin(filename, std::ios::binary);
+    if (!fin)
+    {
+      throw std::runtime_error("failed to open " + filename);
+    }
+    Lexer lexer(fin, use_arrays);
+    return read_one(lexer, alloc);
+  }
 }
 
 std::vector<Value>
-Parser::from_stream_many(std::istream& stream, bool use_arrays)
+Parser::read_file_many(std::string const& filename, Allocator alloc, bool use_arrays)
+{
+  MappedFile file(filename);
+  if (file.is_mapped())
+  {
+    Lexer lexer(file.get_data(), use_arrays);
+    return read_all(lexer, alloc);
+  }
+  else
+  {
+    std::ifstream fin(filename, std::ios::binary);
+    if (!fin)
+    {
+      throw std::runtime_error("failed to open " + filename);
+    }
+    Lexer lexer(fin, use_arrays);
+    return read_all(lexer, alloc);
+  }
+}
+
+struct Parser::Frame
+{
+  enum Kind { LIST, DOTTED_LIST, ARRAY };
+
+  Kind kind;
+  int line;
+
+  /** The list being built and its last cons cell, nullptr when the
+      last cell is \a list itself */
+  Value list;
+  Value* tail;
+
+  std::vector<Value> array;
+};
+
+Parser::Parser(Lexer& lexer, int max_depth) :
+  m_lexer(lexer),
+  m_alloc{nullptr, nullptr},
+  m_token(m_lexer.get_next_token()),
+  m_max_depth(max_depth),
+  m_line_numbers(true),
+  m_typed_arrays(false),
+  m_stack()
+{
+}
+
+Parser::Parser(Lexer& lexer, Arena& arena, int max_depth) :
+  m_lexer(lexer),
+  m_alloc{&arena, nullptr},
+  m_token(m_lexer.get_next_token()),
+  m_max_depth(max_depth),
+  m_line_numbers(true),
+  m_typed_arrays(false),
+  m_stack()
+{
+}
+
+Parser::Parser(Lexer& lexer, std::pmr::memory_resource& resource, int max_depth) :
+  m_lexer(lexer),
+  m_alloc{nullptr, &resource},
+  m_token(m_lexer.get_next_token()),
+  m_max_depth(max_depth),
+  m_line_numbers(true),
+  m_typed_arrays(false),
+  m_stack()
 {
-  Lexer lexer(stream, use_arrays);
-  Parser parser(lexer);
-  return parser.read_many();
 }
 
-Parser::Parser(Lexer& lexer) :
+Parser::Parser(Lexer& lexer, Lexer::TokenType token) :
   m_lexer(lexer),
-  m_token(m_lexer.get_next_token())
+  m_alloc{nullptr, nullptr},
+  m_token(token),
+  m_max_depth(DEFAULT_MAX_DEPTH),
+  m_line_numbers(true),
+  m_typed_arrays(false),
+  m_stack()
 {
 }
 
@@ -71,6 +434,13 @@ Parser::~Parser()
 {
 }
 
+void
+Parser::reset()
+{
+  m_stack.clear();
+  m_token = m_lexer.get_next_token();
+}
+
 void
 Parser::parse_error(const char* msg) const
 {
@@ -91,103 +461,272 @@ Parser::read_many()
   return results;
 }
 
+Value
+Parser::make_string(std::string_view text)
+{
+  if (m_alloc.arena) {
+    return Value::string(text, *m_alloc.arena);
+  } else if (m_alloc.resource) {
+    return Value::string(text, *m_alloc.resource);
+  } else {
+    return Value::string(text);
+  }
+}
+
+Value
+Parser::make_cons(Value&& car)
+{
+  if (m_alloc.arena) {
+    return Value::cons(std::move(car), Value::nil(), *m_alloc.arena);
+  } else if (m_alloc.resource) {
+    return Value::cons(std::move(car), Value::nil(), *m_alloc.resource);
+  } else {
+    return Value::cons(std::move(car), Value::nil());
+  }
+}
+
+Value
+Parser::make_array(std::vector<Value>&& arr)
+{
+  // arrays of only integers or only reals are stored as plain numbers
+  Value::Type const type = (!m_typed_arrays || arr.empty()) ? Value::Type::NIL : arr.front().get_type();
+  bool const homogeneous = std::all_of(arr.begin(), arr.end(),
+                                       [type](Value const& item) { return item.get_type() == type; });
+
+  if (homogeneous && type == Value::Type::INTEGER)
+  {
+    std::vector<int> data(arr.size());
+    std::transform(arr.begin(), arr.end(), data.begin(), [](Value const& item) { return item.as_int(); });
+    if (m_alloc.arena) {
+      return Value::int_array(std::move(data), *m_alloc.arena);
+    } else if (m_alloc.resource) {
+      return Value::int_array(std::move(data), *m_alloc.resource);
+    } else {
+      return Value::int_array(std::move(data));
+    }
+  }
+  else if (homogeneous && type == Value::Type::REAL)
+  {
+    std::vector<float> data(arr.size());
+    std::transform(arr.begin(), arr.end(), data.begin(), [](Value const& item) { return item.as_float(); });
+    if (m_alloc.arena) {
+      return Value::real_array(std::move(data), *m_alloc.arena);
+    } else if (m_alloc.resource) {
+      return Value::real_array(std::move(data), *m_alloc.resource);
+    } else {
+      return Value::real_array(std::move(data));
+    }
+  }
+  else
+  {
+    if (m_alloc.arena) {
+      return Value::array(std::move(arr), *m_alloc.arena);
+    } else if (m_alloc.resource) {
+      return Value::array(std::move(arr), *m_alloc.resource);
+    } else {
+      return Value::array(std::move(arr));
+    }
+  }
+}
+
 Value
 Parser::read()
 {
-  Value result;
-  int line_number = m_lexer.get_line_number();
+  // Lists and arrays are read with an explicit stack instead of
+  // recursion, so the nesting depth is only limited by m_max_depth
+  m_stack.clear();
 
-  switch(m_token)
+  while(true)
   {
-    case Lexer::TOKEN_OPEN_PAREN:
-      m_token = m_lexer.get_next_token();
-      if(m_token == Lexer::TOKEN_CLOSE_PAREN)
+    Value result;
+    int line_number = m_line_numbers ? m_lexer.get_line_number() : 0;
+
+    switch(m_token)
+    {
+      case Lexer::TOKEN_OPEN_PAREN:
+        m_token = m_lexer.get_next_token();
+        if (m_token == Lexer::TOKEN_CLOSE_PAREN)
+        {
+          result = Value::nil();
+          break;
+        }
+        else
+        {
+          if (static_cast<int>(m_stack.size()) >= m_max_depth)
+          {
+            parse_error("Nesting too deep.");
+          }
+          m_stack.push_back(Frame{Frame::LIST, line_number, Value(), nullptr, {}});
+          continue;
+        }
+
+      case Lexer::TOKEN_SYMBOL:
+        result = Value::symbol(m_lexer.get_string_view());
+        break;
+
+      case Lexer::TOKEN_STRING:
+        result = make_string(m_lexer.get_string_view());
+        break;
+
+      case Lexer::TOKEN_INTEGER:
+        result = Value::integer(m_lexer.get_integer());
+        break;
+
+      case Lexer::TOKEN_REAL:
+        result = Value::real(m_lexer.get_real());
+        break;
+
+      case Lexer::TOKEN_TRUE:
+        result = Value::boolean(true);
+        break;
+
+      case Lexer::TOKEN_FALSE:
+        result = Value::boolean(false);
+        break;
+
+      case Lexer::TOKEN_ARRAY_START:
+        if (static_cast<int>(m_stack.size()) >= m_max_depth)
+        {
+          parse_error("Nesting too deep.");
+        }
+        m_token = m_lexer.get_next_token();
+        m_stack.push_back(Frame{Frame::ARRAY, line_number, Value(), nullptr, {}});
+        continue;
+
+      case Lexer::TOKEN_EOF:
+        parse_error("Unexpected EOF.");
+        break;
+
+      case Lexer::TOKEN_CLOSE_PAREN:
+        parse_error("Unexpected ')'.");
+        break;
+
+      case Lexer::TOKEN_DOT:
+        parse_error("Unexpected '.'.");
+        break;
+
+      default:
+        assert(false && "this should never happen");
+        break;
+    }
+
+    m_token = m_lexer.get_next_token();
+    result.set_line(line_number);
+
+    // hand the finished value to the enclosing list or array, which
+    // in turn might be finished by a following ')'
+    while(true)
+    {
+      if (m_stack.empty())
       {
-        result = Value::nil();
+        return result;
       }
-      else
+
+      Frame& frame = m_stack.back();
+      bool finished = false;
+      switch(frame.kind)
       {
-        result = Value::cons(read(), Value::nil());
-        Value* cur = &result;
-        while(m_token != Lexer::TOKEN_CLOSE_PAREN)
-        {
+        case Frame::LIST:
+          if (frame.list.is_nil())
+          {
+            frame.list = make_cons(std::move(result));
+          }
+          else
+          {
+            Value& tail = frame.tail ? *frame.tail : frame.list;
+            tail.set_cdr(make_cons(std::move(result)));
+            frame.tail = &tail.get_cdr();
+          }
+
           if (m_token == Lexer::TOKEN_DOT)
           {
             m_token = m_lexer.get_next_token();
-            cur->set_cdr(read());
-            if (m_token != Lexer::TOKEN_CLOSE_PAREN)
-            {
-              parse_error("Expected ')'");
-            }
-            break;
+            frame.kind = Frame::DOTTED_LIST;
           }
           else
           {
-            cur->set_cdr(Value::cons(read(), Value::nil()));
-            cur = &cur->get_cdr();
+            finished = (m_token == Lexer::TOKEN_CLOSE_PAREN);
           }
-        }
-      }
-      break;
-
-    case Lexer::TOKEN_SYMBOL:
-      result = Value::symbol(m_lexer.get_string());
-      break;
-
-    case Lexer::TOKEN_STRING:
-      result = Value::string(m_lexer.get_string());
-      break;
-
-    case Lexer::TOKEN_INTEGER:
-      result = Value::integer(std::stoi(m_lexer.get_string()));
-      break;
-
-    case Lexer::TOKEN_REAL:
-      result = Value::real(string2float(m_lexer.get_string()));
-      break;
+          break;
 
-    case Lexer::TOKEN_TRUE:
-      result = Value::boolean(true);
-      break;
+        case Frame::DOTTED_LIST:
+          (frame.tail ? *frame.tail : frame.list).set_cdr(std::move(result));
+          if (m_token != Lexer::TOKEN_CLOSE_PAREN)
+          {
+            parse_error("Expected ')'");
+          }
+          finished = true;
+          break;
 
-    case Lexer::TOKEN_FALSE:
-      result = Value::boolean(false);
-      break;
+        case Frame::ARRAY:
+          frame.array.emplace_back(std::move(result));
+          finished = (m_token == Lexer::TOKEN_CLOSE_PAREN);
+          break;
+      }
 
-    case Lexer::TOKEN_ARRAY_START:
+      if (!finished)
       {
-        m_token = m_lexer.get_next_token();
-        std::vector<Value> arr;
-        do
+        // read the next element
+        break;
+      }
+      else
+      {
+        if (frame.kind == Frame::ARRAY)
         {
-          arr.emplace_back(read());
+          result = make_array(std::move(frame.array));
         }
-        while(m_token != Lexer::TOKEN_CLOSE_PAREN);
-        result = Value::array(std::move(arr));
-      }
-      break;
+        else
+        {
+          result = std::move(frame.list);
+        }
+        line_number = frame.line;
+        m_stack.pop_back();
 
-    case Lexer::TOKEN_EOF:
-      parse_error("Unexpected EOF.");
-      break;
+        m_token = m_lexer.get_next_token();
+        result.set_line(line_number);
+      }
+    }
+  }
+}
 
-    case Lexer::TOKEN_CLOSE_PAREN:
-      parse_error("Unexpected ')'.");
-      break;
+FormRange::FormRange(std::istream& stream, bool use_arrays) :
+  m_lexer(stream, use_arrays),
+  m_parser(m_lexer),
+  m_value()
+{
+}
 
-    case Lexer::TOKEN_DOT:
-      parse_error("Unexpected '.'.");
-      break;
+FormRange::FormRange(std::string_view str, bool use_arrays) :
+  m_lexer(str, use_arrays),
+  m_parser(m_lexer),
+  m_value()
+{
+}
 
-    default:
-      assert(false && "this should never happen");
-      break;
-  }
+FormRange::~FormRange()
+{
+}
 
-  m_token = m_lexer.get_next_token();
+FormRange::iterator
+FormRange::begin()
+{
+  return advance() ? iterator(this) : iterator();
+}
 
-  result.set_line(line_number);
-  return result;
+bool
+FormRange::advance()
+{
+  // release the previous form before reading the next
+  m_value = Value();
+  if (m_parser.eof())
+  {
+    return false;
+  }
+  else
+  {
+    m_value = m_parser.read();
+    return true;
+  }
 }
 
 } // namespace sexp
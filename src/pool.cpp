@@ -0,0 +1,266 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sexp/pool.hpp"
+
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__SANITIZE_ADDRESS__)
+#  define SEXP_POOL_BYPASS
+#elif defined(__has_feature)
+#  if __has_feature(address_sanitizer)
+#    define SEXP_POOL_BYPASS
+#  endif
+#endif
+
+#if !defined(SEXP_POOL_ALLOCATOR)
+#  define SEXP_POOL_BYPASS
+#endif
+
+namespace sexp {
+
+#ifndef SEXP_POOL_BYPASS
+
+namespace {
+
+size_t const NUM_CLASSES = Pool::MAX_SIZE / Pool::ALIGNMENT;
+size_t const BATCH_SIZE = 256;
+size_t const CHUNK_SIZE = 64 * 1024;
+
+struct Block
+{
+  Block* next;
+};
+
+struct FreeList
+{
+  Block* head = nullptr;
+  size_t count = 0;
+
+  void push(Block* block)
+  {
+    block->next = head;
+    head = block;
+    count += 1;
+  }
+
+  Block* pop()
+  {
+    Block* block = head;
+    head = block->next;
+    count -= 1;
+    return block;
+  }
+
+  /** Removes up to \a n blocks from the front */
+  FreeList split(size_t n)
+  {
+    FreeList result;
+    result.head = head;
+    Block* last = head;
+    for(result.count = 1; result.count < n && last->next; ++result.count) {
+      last = last->next;
+    }
+    head = last->next;
+    last->next = nullptr;
+    count -= result.count;
+    return result;
+  }
+};
+
+class GlobalPool
+{
+public:
+  GlobalPool() : m_mutex(), m_batches() {}
+
+  FreeList take(size_t size_class)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      std::vector<FreeList>& batches = m_batches[size_class];
+      if (!batches.empty())
+      {
+        FreeList result = batches.back();
+        batches.pop_back();
+        return result;
+      }
+    }
+
+    // chunks are never released, their blocks circulate between the
+    // threads and the global pool
+    size_t const block_size = (size_class + 1) * Pool::ALIGNMENT;
+    char* const chunk = static_cast<char*>(::operator new(CHUNK_SIZE));
+    FreeList result;
+    for(size_t offset = 0; offset + block_size <= CHUNK_SIZE; offset += block_size) {
+      result.push(reinterpret_cast<Block*>(chunk + offset));
+    }
+    return result;
+  }
+
+  void give(size_t size_class, FreeList blocks)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_batches[size_class].push_back(blocks);
+  }
+
+private:
+  std::mutex m_mutex;
+  std::vector<FreeList> m_batches[NUM_CLASSES];
+};
+
+GlobalPool& get_global_pool()
+{
+  // never destroyed, static Values may release memory during shutdown
+  static GlobalPool* const pool = new GlobalPool;
+  return *pool;
+}
+
+class ThreadCache
+{
+public:
+  ThreadCache() : m_lists() {}
+
+  ~ThreadCache()
+  {
+    for(size_t size_class = 0; size_class < NUM_CLASSES; ++size_class)
+    {
+      if (m_lists[size_class].head) {
+        get_global_pool().give(size_class, m_lists[size_class]);
+      }
+    }
+  }
+
+  void* allocate(size_t size_class)
+  {
+    FreeList& list = m_lists[size_class];
+    if (!list.head) {
+      list = get_global_pool().take(size_class);
+    }
+    return list.pop();
+  }
+
+  void deallocate(void* ptr, size_t size_class)
+  {
+    FreeList& list = m_lists[size_class];
+    list.push(static_cast<Block*>(ptr));
+    if (list.count >= 2 * BATCH_SIZE) {
+      get_global_pool().give(size_class, list.split(BATCH_SIZE));
+    }
+  }
+
+private:
+  FreeList m_lists[NUM_CLASSES];
+};
+
+thread_local ThreadCache* t_cache = nullptr;
+thread_local bool t_cache_destroyed = false;
+
+struct ThreadCacheOwner
+{
+  ThreadCacheOwner() { t_cache = new ThreadCache; }
+  ~ThreadCacheOwner()
+  {
+    delete t_cache;
+    t_cache = nullptr;
+    t_cache_destroyed = true;
+  }
+};
+
+/** nullptr once the thread is shutting down, Values destroyed after
+    that go to the global pool directly */
+ThreadCache* get_thread_cache()
+{
+  if (!t_cache && !t_cache_destroyed)
+  {
+    thread_local ThreadCacheOwner owner;
+  }
+  return t_cache;
+}
+
+size_t get_size_class(size_t size)
+{
+  return (size - 1) / Pool::ALIGNMENT;
+}
+
+} // namespace
+
+void*
+Pool::allocate(size_t size)
+{
+  if (size == 0 || size > MAX_SIZE)
+  {
+    return ::operator new(size);
+  }
+
+  size_t const size_class = get_size_class(size);
+  if (ThreadCache* cache = get_thread_cache())
+  {
+    return cache->allocate(size_class);
+  }
+  else
+  {
+    FreeList blocks = get_global_pool().take(size_class);
+    void* const ptr = blocks.pop();
+    if (blocks.head) {
+      get_global_pool().give(size_class, blocks);
+    }
+    return ptr;
+  }
+}
+
+void
+Pool::deallocate(void* ptr, size_t size)
+{
+  if (size == 0 || size > MAX_SIZE)
+  {
+    ::operator delete(ptr);
+    return;
+  }
+
+  size_t const size_class = get_size_class(size);
+  if (ThreadCache* cache = get_thread_cache())
+  {
+    cache->deallocate(ptr, size_class);
+  }
+  else
+  {
+    FreeList blocks;
+    blocks.push(static_cast<Block*>(ptr));
+    get_global_pool().give(size_class, blocks);
+  }
+}
+
+#else
+
+void*
+Pool::allocate(size_t size)
+{
+  return ::operator new(size);
+}
+
+void
+Pool::deallocate(void* ptr, size_t)
+{
+  ::operator delete(ptr);
+}
+
+#endif
+
+} // namespace sexp
+
+/* EOF */
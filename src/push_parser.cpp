@@ -0,0 +1,228 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sexp/push_parser.hpp"
+
+#include <algorithm>
+#include <string.h>
+
+#include "sexp/lexer.hpp"
+#include "sexp/parser.hpp"
+#include "char_class.hpp"
+
+namespace sexp {
+
+PushParser::PushParser(bool use_arrays) :
+  m_use_arrays(use_arrays),
+  m_input(),
+  m_line(0),
+  m_scan_pos(0),
+  m_state(BLANK),
+  m_depth(0),
+  m_hash(false),
+  m_form_end(0),
+  m_blank_end(0),
+  m_values(),
+  m_next(0)
+{
+}
+
+PushParser::~PushParser()
+{
+}
+
+void
+PushParser::feed(char const* data, size_t size)
+{
+  m_input.append(data, size);
+  scan();
+  if (m_form_end != 0) {
+    parse(m_form_end);
+  }
+
+  // blanks and comments between top level forms aren't kept
+  if (m_blank_end != 0) {
+    discard(m_blank_end);
+  }
+}
+
+void
+PushParser::finish()
+{
+  // whatever is left is either blank, a single atom or broken, in
+  // which case the Parser reports the error
+  parse(m_input.size());
+  m_state = BLANK;
+  m_depth = 0;
+}
+
+bool
+PushParser::next(Value& value)
+{
+  if (m_next == m_values.size()) {
+    return false;
+  }
+
+  value = std::move(m_values[m_next]);
+  m_next += 1;
+  return true;
+}
+
+void
+PushParser::scan()
+{
+  // The Lexer reads one character past an atom or string, a newline
+  // there already counts for its line number. When a top level form
+  // ends in one, the following whitespace is made part of the form, so
+  // that parsing the pieces gives the same lines as the whole input.
+  char const* const begin = m_input.data();
+  char const* const end = begin + m_input.size();
+  char const* p = begin + m_scan_pos;
+  while(true)
+  {
+    // only a few characters are of interest within strings, comments
+    // and lists, those are looked for in bulk
+    if (m_state == STRING) {
+      p = find_any(p, end, '"', '\\', '"', '\\');
+    } else if (m_state == COMMENT) {
+      void const* const eol = memchr(p, '\n', static_cast<size_t>(end - p));
+      p = eol ? static_cast<char const*>(eol) : end;
+    } else if (m_state == BLANK && m_depth > 0) {
+      p = find_any(p, end, '(', ')', '"', ';');
+    }
+
+    if (p == end) {
+      break;
+    }
+
+    char const c = *p;
+    size_t const pos = static_cast<size_t>(p - begin);
+    p += 1;
+    switch(m_state)
+    {
+      case ATOM:
+        if (m_hash && c == '(') {
+          // "#(" starts an array
+          m_depth += 1;
+          m_state = BLANK;
+          break;
+        }
+        m_hash = false;
+        if (!(char_class(c) & CHAR_TOKEN_END)) {
+          break;
+        }
+        m_form_end = is_space(c) ? pos + 1 : pos;
+        m_state = BLANK;
+        goto blank;
+
+      case STRING:
+        if (c == '\\') {
+          m_state = STRING_ESCAPE;
+        } else {
+          m_state = (m_depth == 0) ? STRING_END : BLANK;
+        }
+        break;
+
+      case STRING_ESCAPE:
+        m_state = STRING;
+        break;
+
+      case STRING_END:
+        m_form_end = is_space(c) ? pos + 1 : pos;
+        m_state = BLANK;
+        goto blank;
+
+      case COMMENT:
+        m_state = BLANK;
+        if (m_depth == 0) {
+          m_blank_end = pos + 1;
+        }
+        break;
+
+      case BLANK:
+      blank:
+        switch(c)
+        {
+          case '(':
+            m_depth += 1;
+            break;
+
+          case ')':
+            m_depth -= 1;
+            if (m_depth <= 0) {
+              // a ')' too many is left for the Parser to report
+              m_depth = 0;
+              m_form_end = pos + 1;
+            }
+            break;
+
+          case '"':
+            m_state = STRING;
+            break;
+
+          case ';':
+            m_state = COMMENT;
+            break;
+
+          default:
+            // atoms only matter at the top level, where their end is
+            // the end of a form
+            if (m_depth != 0) {
+              // part of a list
+            } else if (is_space(c)) {
+              m_blank_end = pos + 1;
+            } else {
+              m_state = ATOM;
+              m_hash = (c == '#');
+            }
+            break;
+        }
+        break;
+    }
+  }
+  m_scan_pos = m_input.size();
+}
+
+void
+PushParser::parse(size_t size)
+{
+  if (m_next == m_values.size()) {
+    m_values.clear();
+    m_next = 0;
+  }
+
+  Lexer lexer(std::string_view(m_input.data(), size), m_use_arrays, m_line);
+  Parser parser(lexer);
+  while(!parser.eof()) {
+    m_values.push_back(parser.read());
+  }
+
+  discard(size);
+  m_form_end = 0;
+}
+
+void
+PushParser::discard(size_t size)
+{
+  m_line += static_cast<int>(std::count(m_input.begin(), m_input.begin() + static_cast<long>(size), '\n'));
+  m_input.erase(0, size);
+  m_scan_pos -= size;
+  m_blank_end = (m_blank_end > size) ? m_blank_end - size : 0;
+}
+
+} // namespace sexp
+
+/* EOF */
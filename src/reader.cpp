@@ -0,0 +1,326 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sexp/reader.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+#include "sexp/parser.hpp"
+
+namespace sexp {
+
+Reader::Reader(Lexer& lexer) :
+  m_lexer(lexer),
+  m_token(m_lexer.get_next_token()),
+  m_line(m_lexer.get_line_number()),
+  m_state(BEFORE),
+  m_frames()
+{
+}
+
+Reader::~Reader()
+{
+}
+
+void
+Reader::parse_error(const char* msg) const
+{
+  std::stringstream emsg;
+  emsg << "Parse Error at line " << m_lexer.get_line_number()
+       << ": " << msg;
+  throw std::runtime_error(emsg.str());
+}
+
+void
+Reader::require_element(const char* msg) const
+{
+  if (m_state != ON)
+  {
+    throw TypeError(m_line, msg);
+  }
+}
+
+void
+Reader::advance()
+{
+  m_token = m_lexer.get_next_token();
+  m_line = m_lexer.get_line_number();
+}
+
+void
+Reader::push_frame()
+{
+  m_frames.push_back(m_token == Lexer::TOKEN_ARRAY_START ? EMPTY_ARRAY : EMPTY_LIST);
+  advance();
+}
+
+void
+Reader::finish_element()
+{
+  if (!m_frames.empty())
+  {
+    switch(m_frames.back())
+    {
+      case EMPTY_LIST:
+        m_frames.back() = LIST;
+        break;
+
+      case EMPTY_ARRAY:
+        m_frames.back() = ARRAY;
+        break;
+
+      case DOT:
+        m_frames.back() = DOTTED_LIST;
+        break;
+
+      default:
+        break;
+    }
+  }
+}
+
+void
+Reader::check_separator()
+{
+  Frame& frame = m_frames.back();
+  if (m_token == Lexer::TOKEN_DOT)
+  {
+    if (frame != LIST)
+    {
+      parse_error("Unexpected '.'.");
+    }
+    frame = DOT;
+    advance();
+  }
+
+  if (frame == DOTTED_LIST && m_token != Lexer::TOKEN_CLOSE_PAREN)
+  {
+    parse_error("Expected ')'");
+  }
+
+  // Parser has no representation for an empty array
+  if (m_token == Lexer::TOKEN_CLOSE_PAREN && (frame == DOT || frame == EMPTY_ARRAY))
+  {
+    parse_error("Unexpected ')'.");
+  }
+}
+
+void
+Reader::skip_element()
+{
+  if (m_token == Lexer::TOKEN_OPEN_PAREN || m_token == Lexer::TOKEN_ARRAY_START)
+  {
+    size_t const depth = m_frames.size();
+    push_frame();
+    while(m_frames.size() > depth)
+    {
+      check_separator();
+      switch(m_token)
+      {
+        case Lexer::TOKEN_OPEN_PAREN:
+        case Lexer::TOKEN_ARRAY_START:
+          push_frame();
+          break;
+
+        case Lexer::TOKEN_CLOSE_PAREN:
+          m_frames.pop_back();
+          advance();
+          if (m_frames.size() > depth)
+          {
+            finish_element();
+          }
+          break;
+
+        case Lexer::TOKEN_EOF:
+          parse_error("Unexpected EOF.");
+
+        case Lexer::TOKEN_DOT:
+          parse_error("Unexpected '.'.");
+
+        default:
+          advance();
+          finish_element();
+          break;
+      }
+    }
+  }
+  else
+  {
+    advance();
+  }
+  m_state = CONSUMED;
+}
+
+bool
+Reader::next()
+{
+  switch(m_state)
+  {
+    case END:
+      return false;
+
+    case ON:
+      skip_element();
+      finish_element();
+      break;
+
+    case CONSUMED:
+      finish_element();
+      break;
+
+    case BEFORE:
+      break;
+  }
+
+  if (!m_frames.empty())
+  {
+    check_separator();
+  }
+
+  switch(m_token)
+  {
+    case Lexer::TOKEN_CLOSE_PAREN:
+      if (m_frames.empty())
+      {
+        parse_error("Unexpected ')'.");
+      }
+      m_state = END;
+      return false;
+
+    case Lexer::TOKEN_EOF:
+      if (!m_frames.empty())
+      {
+        parse_error("Unexpected EOF.");
+      }
+      m_state = END;
+      return false;
+
+    case Lexer::TOKEN_DOT:
+      parse_error("Unexpected '.'.");
+
+    default:
+      m_state = ON;
+      return true;
+  }
+}
+
+void
+Reader::enter()
+{
+  require_element("sexp::Reader::enter(): no current element");
+  if (!is_list() && !is_array())
+  {
+    throw TypeError(m_line, "sexp::Reader::enter(): wrong type, expected list or array");
+  }
+  push_frame();
+  m_state = BEFORE;
+}
+
+void
+Reader::skip()
+{
+  while(next()) {}
+}
+
+void
+Reader::leave()
+{
+  if (m_frames.empty())
+  {
+    throw std::logic_error("sexp::Reader::leave(): not inside a list");
+  }
+  skip();
+  advance();
+  m_frames.pop_back();
+  m_state = CONSUMED;
+}
+
+Value
+Reader::materialize()
+{
+  require_element("sexp::Reader::materialize(): no current element");
+  Parser parser(m_lexer, m_token);
+  Value result = parser.read();
+  m_token = parser.m_token;
+  m_line = m_lexer.get_line_number();
+  m_state = CONSUMED;
+  return result;
+}
+
+std::string_view
+Reader::get_string_view() const
+{
+  require_element("sexp::Reader::get_string_view(): no current element");
+  if (m_token == Lexer::TOKEN_SYMBOL || m_token == Lexer::TOKEN_STRING)
+  {
+    return m_lexer.get_string_view();
+  }
+  else
+  {
+    throw TypeError(m_line, "sexp::Reader::get_string_view(): wrong type, expected Type::SYMBOL or Type::STRING");
+  }
+}
+
+int
+Reader::as_int() const
+{
+  require_element("sexp::Reader::as_int(): no current element");
+  if (m_token == Lexer::TOKEN_INTEGER)
+  {
+    return m_lexer.get_integer();
+  }
+  else
+  {
+    throw TypeError(m_line, "sexp::Reader::as_int(): wrong type, expected Type::INTEGER");
+  }
+}
+
+float
+Reader::as_float() const
+{
+  require_element("sexp::Reader::as_float(): no current element");
+  if (m_token == Lexer::TOKEN_REAL)
+  {
+    return m_lexer.get_real();
+  }
+  else if (m_token == Lexer::TOKEN_INTEGER)
+  {
+    return static_cast<float>(m_lexer.get_integer());
+  }
+  else
+  {
+    throw TypeError(m_line, "sexp::Reader::as_float(): wrong type, expected Type::INTEGER or Type::REAL");
+  }
+}
+
+bool
+Reader::as_bool() const
+{
+  require_element("sexp::Reader::as_bool(): no current element");
+  if (m_token == Lexer::TOKEN_TRUE || m_token == Lexer::TOKEN_FALSE)
+  {
+    return m_token == Lexer::TOKEN_TRUE;
+  }
+  else
+  {
+    throw TypeError(m_line, "sexp::Reader::as_bool(): wrong type, expected Type::BOOLEAN");
+  }
+}
+
+} // namespace sexp
+
+/* EOF */
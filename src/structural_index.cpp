@@ -0,0 +1,500 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "structural_index.hpp"
+
+#include <bit>
+#include <string.h>
+
+#include "simd.hpp"
+
+#if defined(SEXP_HAVE_SSE2) && defined(__GNUC__)
+#  define SEXP_HAVE_AVX2
+#  include <immintrin.h>
+#endif
+
+namespace sexp {
+
+namespace {
+
+/** Raw character classes of a block, not yet aware of strings and
+    comments */
+struct CharMasks
+{
+  uint64_t whitespace;
+  uint64_t quote;
+  uint64_t backslash;
+  uint64_t semicolon;
+  uint64_t newline;
+  uint64_t open_paren;
+  uint64_t close_paren;
+};
+
+using ClassifyFunc = CharMasks (*)(char const* block);
+
+#ifndef SEXP_HAVE_SSE2
+CharMasks classify_scalar(char const* block)
+{
+  CharMasks masks{};
+  for(unsigned i = 0; i < StructuralScanner::BLOCK_SIZE; ++i)
+  {
+    uint64_t const bit = uint64_t(1) << i;
+    switch(block[i])
+    {
+      case '\n':
+        masks.newline |= bit;
+        masks.whitespace |= bit;
+        break;
+      case ' ': case '\t': case '\v': case '\f': case '\r':
+        masks.whitespace |= bit;
+        break;
+      case '"': masks.quote |= bit; break;
+      case '\\': masks.backslash |= bit; break;
+      case ';': masks.semicolon |= bit; break;
+      case '(': masks.open_paren |= bit; break;
+      case ')': masks.close_paren |= bit; break;
+      default: break;
+    }
+  }
+  return masks;
+}
+#endif
+
+#ifdef SEXP_HAVE_SSE2
+CharMasks classify_sse2(char const* block)
+{
+  CharMasks masks{};
+  for(unsigned i = 0; i < 4; ++i)
+  {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(block + 16 * i)); // NOLINT
+    auto const to_mask = [i](__m128i cmp) {
+      return static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(cmp))) << (16 * i);
+    };
+
+    // '\t', '\n', '\v', '\f' and '\r' are the range [9, 13]
+    __m128i const ctrl = _mm_sub_epi8(v, _mm_set1_epi8(9));
+    __m128i const is_ctrl = _mm_cmpeq_epi8(_mm_min_epu8(ctrl, _mm_set1_epi8(4)), ctrl);
+
+    masks.whitespace |= to_mask(_mm_or_si128(is_ctrl, _mm_cmpeq_epi8(v, _mm_set1_epi8(' '))));
+    masks.newline |= to_mask(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+    masks.quote |= to_mask(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+    masks.backslash |= to_mask(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+    masks.semicolon |= to_mask(_mm_cmpeq_epi8(v, _mm_set1_epi8(';')));
+    masks.open_paren |= to_mask(_mm_cmpeq_epi8(v, _mm_set1_epi8('(')));
+    masks.close_paren |= to_mask(_mm_cmpeq_epi8(v, _mm_set1_epi8(')')));
+  }
+  return masks;
+}
+#endif
+
+#ifdef SEXP_HAVE_AVX2
+__attribute__((target("avx2")))
+CharMasks classify_avx2(char const* block)
+{
+  CharMasks masks{};
+  for(unsigned i = 0; i < 2; ++i)
+  {
+    __m256i const v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(block + 32 * i)); // NOLINT
+    auto const to_mask = [i](__m256i cmp) __attribute__((target("avx2"))) {
+      return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(cmp))) << (32 * i);
+    };
+
+    __m256i const ctrl = _mm256_sub_epi8(v, _mm256_set1_epi8(9));
+    __m256i const is_ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(ctrl, _mm256_set1_epi8(4)), ctrl);
+
+    masks.whitespace |= to_mask(_mm256_or_si256(is_ctrl, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '))));
+    masks.newline |= to_mask(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+    masks.quote |= to_mask(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+    masks.backslash |= to_mask(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+    masks.semicolon |= to_mask(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(';')));
+    masks.open_paren |= to_mask(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('(')));
+    masks.close_paren |= to_mask(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(')')));
+  }
+  return masks;
+}
+#endif
+
+ClassifyFunc select_classify()
+{
+#ifdef SEXP_HAVE_AVX2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return classify_avx2;
+  }
+#endif
+
+#ifdef SEXP_HAVE_SSE2
+  return classify_sse2;
+#else
+  return classify_scalar;
+#endif
+}
+
+CharMasks classify(char const* block)
+{
+  static ClassifyFunc const func = select_classify();
+  return func(block);
+}
+
+/** All bits from \a pos upwards */
+inline uint64_t mask_from(unsigned pos)
+{
+  return pos >= 64 ? 0 : (~uint64_t(0) << pos);
+}
+
+/** All bits in the range [begin, end) */
+inline uint64_t mask_range(unsigned begin, unsigned end)
+{
+  return mask_from(begin) & ~mask_from(end);
+}
+
+/** Bit N of the result is the XOR of bits [0, N] of \a bits */
+inline uint64_t prefix_xor(uint64_t bits)
+{
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+}
+
+/** Returns the characters escaped by a backslash, \a carry tells if
+    the first character is escaped and is updated for the next block,
+    see "Parsing Gigabytes of JSON per Second" by Langdale and Lemire */
+inline uint64_t find_escaped(uint64_t backslash, bool& carry)
+{
+  uint64_t const even_bits = 0x5555555555555555ULL;
+
+  backslash &= ~static_cast<uint64_t>(carry);
+  uint64_t const follows_escape = (backslash << 1) | static_cast<uint64_t>(carry);
+  uint64_t const odd_starts = backslash & ~even_bits & ~follows_escape;
+  uint64_t const even_sequences = odd_starts + backslash;
+  carry = even_sequences < odd_starts;
+  uint64_t const invert_mask = even_sequences << 1;
+  return (even_bits ^ invert_mask) & follows_escape;
+}
+
+} // namespace
+
+StructuralScanner::StructuralScanner() :
+  m_in_string(false),
+  m_in_comment(false),
+  m_escape(false),
+  m_prev_atom(false)
+{
+}
+
+StructuralBlock
+StructuralScanner::next(char const* block)
+{
+  CharMasks const masks = classify(block);
+
+  uint64_t string_mask = 0; // string content including the closing quote
+  uint64_t comment_mask = 0; // from ';' up to, but excluding, the newline
+
+  // Strings alone can be resolved with pure bit arithmetic, but that
+  // goes wrong when a comment or a backslash outside of a string is
+  // involved, as those are rare it's cheaper to detect them after the
+  // fact and redo the block by walking from event to event.
+  bool slow_path = m_in_comment;
+  if (!slow_path)
+  {
+    bool escape = m_escape;
+    uint64_t const escaped = find_escaped(masks.backslash, escape);
+    uint64_t const quote = masks.quote & ~escaped;
+    uint64_t const inside = prefix_xor(quote) ^ (m_in_string ? ~uint64_t(0) : 0);
+    string_mask = inside ^ quote;
+
+    if (((masks.semicolon | masks.backslash) & ~string_mask) == 0)
+    {
+      m_in_string = (inside >> 63) != 0;
+      m_escape = escape;
+    }
+    else
+    {
+      string_mask = 0;
+      slow_path = true;
+    }
+  }
+
+  if (slow_path)
+  {
+    unsigned pos = 0;
+    while(pos < BLOCK_SIZE)
+    {
+      if (m_in_string)
+      {
+        if (m_escape)
+        {
+          m_escape = false;
+          string_mask |= mask_range(pos, pos + 1);
+          pos += 1;
+          continue;
+        }
+
+        uint64_t const events = (masks.quote | masks.backslash) & mask_from(pos);
+        if (!events)
+        {
+          string_mask |= mask_from(pos);
+          pos = BLOCK_SIZE;
+        }
+        else
+        {
+          unsigned const idx = static_cast<unsigned>(std::countr_zero(events));
+          string_mask |= mask_range(pos, idx + 1);
+          if ((masks.backslash >> idx) & 1) {
+            m_escape = true;
+          } else {
+            m_in_string = false;
+          }
+          pos = idx + 1;
+        }
+      }
+      else if (m_in_comment)
+      {
+        uint64_t const events = masks.newline & mask_from(pos);
+        if (!events)
+        {
+          comment_mask |= mask_from(pos);
+          pos = BLOCK_SIZE;
+        }
+        else
+        {
+          unsigned const idx = static_cast<unsigned>(std::countr_zero(events));
+          comment_mask |= mask_range(pos, idx);
+          m_in_comment = false;
+          pos = idx;
+        }
+      }
+      else
+      {
+        uint64_t const events = (masks.quote | masks.semicolon) & mask_from(pos);
+        if (!events)
+        {
+          break;
+        }
+
+        unsigned const idx = static_cast<unsigned>(std::countr_zero(events));
+        if ((masks.quote >> idx) & 1)
+        {
+          // the opening quote itself is the start of the token
+          m_in_string = true;
+          pos = idx + 1;
+        }
+        else
+        {
+          m_in_comment = true;
+          pos = idx;
+        }
+      }
+    }
+  }
+
+  uint64_t const masked = string_mask | comment_mask;
+  uint64_t const whitespace = masks.whitespace & ~masked;
+  uint64_t const open_paren = masks.open_paren & ~masked;
+  uint64_t const close_paren = masks.close_paren & ~masked;
+  uint64_t const quote = masks.quote & ~masked;
+
+  uint64_t const atom = ~(whitespace | masked | open_paren | close_paren | quote);
+  uint64_t const atom_start = atom & ~((atom << 1) | (m_prev_atom ? 1 : 0));
+  m_prev_atom = (atom >> 63) != 0;
+
+  return StructuralBlock{
+    open_paren | close_paren | quote | atom_start,
+    whitespace | comment_mask,
+    masks.newline,
+    open_paren,
+    close_paren
+  };
+}
+
+StructuralIndex::StructuralIndex(std::string_view text) :
+  m_starts(),
+  m_newlines(),
+  m_newline_counts(),
+  m_open_string(false)
+{
+  size_t const block_size = StructuralScanner::BLOCK_SIZE;
+
+  m_starts.reserve(text.size() / 8);
+  m_newlines.reserve(text.size() / block_size + 1);
+  m_newline_counts.reserve(text.size() / block_size + 2);
+  m_newline_counts.push_back(0);
+
+  StructuralScanner scanner;
+  auto const append = [this](StructuralBlock const& block, size_t base) {
+    m_newlines.push_back(block.newline);
+    m_newline_counts.push_back(m_newline_counts.back() + static_cast<uint32_t>(std::popcount(block.newline)));
+
+    uint64_t bits = block.starts;
+    size_t idx = m_starts.size();
+    m_starts.resize(idx + static_cast<size_t>(std::popcount(bits)));
+    while(bits)
+    {
+      m_starts[idx++] = static_cast<uint32_t>(base + static_cast<size_t>(std::countr_zero(bits)));
+      bits &= bits - 1;
+    }
+  };
+
+  size_t pos = 0;
+  for(; pos + block_size <= text.size(); pos += block_size)
+  {
+    append(scanner.next(text.data() + pos), pos);
+  }
+
+  if (pos < text.size())
+  {
+    // pad the last partial block with whitespace
+    char block[StructuralScanner::BLOCK_SIZE];
+    memset(block, ' ', sizeof(block));
+    memcpy(block, text.data() + pos, text.size() - pos);
+    append(scanner.next(block), pos);
+  }
+
+  m_open_string = scanner.in_string();
+}
+
+bool
+is_worth_indexing(std::string_view text)
+{
+  size_t const sample_size = 1024;
+  size_t const num_samples = 4;
+
+  if (text.size() < sample_size * num_samples) {
+    return false;
+  }
+
+  // count the bytes that stepping through one by one would cost in
+  // excess of a single separator per token
+  size_t tokens = 0;
+  size_t skippable = 0;
+  for(size_t sample = 0; sample < num_samples; ++sample)
+  {
+    size_t const begin = text.size() / num_samples * sample;
+    bool blank = true;
+    bool comment = false;
+    size_t run = 0;
+    for(size_t i = begin; i < begin + sample_size; ++i)
+    {
+      char const c = text[i];
+      if (comment) {
+        comment = (c != '\n');
+      } else if (c == ';') {
+        comment = true;
+      }
+
+      if (comment || c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        blank = true;
+        run += 1;
+      } else if (blank) {
+        blank = false;
+        tokens += 1;
+        skippable += run > 1 ? run - 1 : 0;
+        run = 0;
+      }
+    }
+  }
+
+  return skippable >= 4 * tokens;
+}
+
+std::vector<FormBoundary>
+split_top_level(std::string_view text, size_t chunk_size)
+{
+  size_t const block_size = StructuralScanner::BLOCK_SIZE;
+
+  std::vector<FormBoundary> result;
+  result.push_back(FormBoundary{0, 0});
+
+  StructuralScanner scanner;
+  int depth = 0;
+  int line = 0;
+  size_t target = chunk_size;
+  for(size_t pos = 0; pos < text.size(); pos += block_size)
+  {
+    char tail[StructuralScanner::BLOCK_SIZE];
+    char const* data = text.data() + pos;
+    if (pos + block_size > text.size())
+    {
+      memset(tail, ' ', sizeof(tail));
+      memcpy(tail, data, text.size() - pos);
+      data = tail;
+    }
+    StructuralBlock const block = scanner.next(data);
+
+    // only look at individual tokens once a split is due, everything
+    // else is a matter of counting bits
+    if (pos + block_size > target)
+    {
+      uint64_t bits = block.starts;
+      while(bits)
+      {
+        unsigned const bit = static_cast<unsigned>(std::countr_zero(bits));
+        size_t const offset = pos + bit;
+        uint64_t const before = mask_range(0, bit);
+        if (offset >= target &&
+            depth + std::popcount(block.open_paren & before) - std::popcount(block.close_paren & before) == 0 &&
+            // don't split "#(" apart
+            !(text[offset] == '(' && text[offset - 1] == '#'))
+        {
+          result.push_back(FormBoundary{offset, line + std::popcount(block.newline & before)});
+          target = offset + chunk_size;
+        }
+        bits &= bits - 1;
+      }
+    }
+
+    depth += std::popcount(block.open_paren) - std::popcount(block.close_paren);
+    line += std::popcount(block.newline);
+    if (depth < 0) {
+      break;
+    }
+  }
+
+  if (depth != 0 || scanner.in_string())
+  {
+    result.resize(1);
+  }
+  return result;
+}
+
+int
+StructuralIndex::count_newlines(size_t begin, size_t end) const
+{
+  if (begin >= end) {
+    return 0;
+  }
+  return newlines_before(end) - newlines_before(begin);
+}
+
+int
+StructuralIndex::newlines_before(size_t pos) const
+{
+  size_t const block = pos / StructuralScanner::BLOCK_SIZE;
+  unsigned const bit = static_cast<unsigned>(pos % StructuralScanner::BLOCK_SIZE);
+  int count = static_cast<int>(m_newline_counts[block]);
+  if (bit != 0) {
+    count += std::popcount(m_newlines[block] & mask_range(0, bit));
+  }
+  return count;
+}
+
+} // namespace sexp
+
+/* EOF */
@@ -0,0 +1,124 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SEXP_STRUCTURAL_INDEX_HPP
+#define HEADER_SEXP_STRUCTURAL_INDEX_HPP
+
+#include <stdint.h>
+#include <string_view>
+#include <vector>
+
+namespace sexp {
+
+/** Bitmasks for a single 64 byte block of input, bit N corresponds to
+    byte N of the block. Everything inside of string literals and
+    comments is already masked out. */
+struct StructuralBlock
+{
+  /** First byte of every token */
+  uint64_t starts;
+
+  /** Bytes that are whitespace or part of a comment */
+  uint64_t blank;
+
+  /** All '\n', including those in strings and comments */
+  uint64_t newline;
+
+  uint64_t open_paren;
+  uint64_t close_paren;
+};
+
+/** Classifies input in blocks of 64 bytes using SSE2 or AVX2 when
+    available and keeps track of strings and comments that cross block
+    boundaries. */
+class StructuralScanner
+{
+public:
+  static constexpr size_t BLOCK_SIZE = 64;
+
+public:
+  StructuralScanner();
+
+  /** Classify the next BLOCK_SIZE bytes at \a block */
+  StructuralBlock next(char const* block);
+
+  bool in_string() const { return m_in_string; }
+  bool in_comment() const { return m_in_comment; }
+
+private:
+  bool m_in_string;
+  bool m_in_comment;
+  bool m_escape;
+  bool m_prev_atom;
+};
+
+class StructuralIndex
+{
+public:
+  /** Builds the index for \a text, which must be smaller than 4GB */
+  StructuralIndex(std::string_view text);
+
+  /** The offsets of all token starts, a token is either a
+      parenthesis, the opening quote of a string literal or the first
+      character of any other atom. Whitespace and comments never show
+      up in the index. */
+  std::vector<uint32_t> const& get_starts() const { return m_starts; }
+
+  /** Number of '\n' in the byte range [begin, end) */
+  int count_newlines(size_t begin, size_t end) const;
+
+  /** Number of '\n' before offset \a pos */
+  int newlines_before(size_t pos) const;
+
+  /** True when the text ends inside of a string literal */
+  bool has_open_string() const { return m_open_string; }
+
+private:
+  std::vector<uint32_t> m_starts;
+  std::vector<uint64_t> m_newlines;
+
+  /** Number of '\n' before each block */
+  std::vector<uint32_t> m_newline_counts;
+
+  bool m_open_string;
+};
+
+/** Estimates from a few samples of \a text if the time saved skipping
+    whitespace and comments with a StructuralIndex outweighs the cost
+    of building it. This is the case for indented or commented
+    documents, but not for dense data like long lists of numbers. */
+bool is_worth_indexing(std::string_view text);
+
+/** Start of a piece of input as found by split_top_level() */
+struct FormBoundary
+{
+  size_t offset;
+
+  /** Number of '\n' before \a offset */
+  int line;
+};
+
+/** Splits \a text into pieces of at least \a chunk_size bytes, each
+    piece starts at the beginning of a top level form. The first piece
+    always starts at offset 0. Malformed input, such as unbalanced
+    parentheses or an unterminated string, is not split at all. */
+std::vector<FormBoundary> split_top_level(std::string_view text, size_t chunk_size);
+
+} // namespace sexp
+
+#endif
+
+/* EOF */
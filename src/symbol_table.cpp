@@ -0,0 +1,146 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sexp/symbol_table.hpp"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+
+namespace sexp {
+
+namespace {
+
+struct NameHash
+{
+  using is_transparent = void;
+  size_t operator()(std::string_view name) const { return std::hash<std::string_view>()(name); }
+};
+
+struct NameEqual
+{
+  using is_transparent = void;
+  bool operator()(std::string_view lhs, std::string_view rhs) const { return lhs == rhs; }
+};
+
+/** The table is split into shards with their own lock, so threads
+    parsing in parallel rarely wait for each other */
+struct Shard
+{
+  std::shared_mutex mutex;
+  std::unordered_set<std::string, NameHash, NameEqual> names;
+};
+
+size_t const NUM_SHARDS = 32;
+size_t const CACHE_SIZE = 256;
+
+std::atomic<size_t> g_size(0);
+std::atomic<size_t> g_max_size(SymbolTable::DEFAULT_MAX_SIZE);
+
+Shard* get_shards()
+{
+  // never destroyed, symbols may still be in use by static Values
+  // during shutdown
+  static Shard* const shards = new Shard[NUM_SHARDS];
+  return shards;
+}
+
+Shard& get_shard(size_t hash)
+{
+  // the low bits select the bucket within the shard
+  return get_shards()[(hash >> 16) % NUM_SHARDS];
+}
+
+} // namespace
+
+std::string const*
+SymbolTable::intern(std::string_view name)
+{
+  size_t const hash = NameHash()(name);
+
+  // documents repeat the same few symbols over and over, a small per
+  // thread cache answers most lookups without touching a lock
+  thread_local std::string const* cache[CACHE_SIZE] = {};
+  std::string const*& cached = cache[hash % CACHE_SIZE];
+  if (cached && *cached == name) {
+    return cached;
+  }
+
+  Shard& shard = get_shard(hash);
+  {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.names.find(name);
+    if (it != shard.names.end()) {
+      cached = &*it;
+      return cached;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  auto it = shard.names.find(name);
+  if (it == shard.names.end())
+  {
+    // the slot is taken before inserting, so threads adding names to
+    // different shards can't overshoot the limit together
+    if (g_size.fetch_add(1, std::memory_order_relaxed) >= g_max_size.load(std::memory_order_relaxed))
+    {
+      g_size.fetch_sub(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    it = shard.names.emplace(name).first;
+  }
+  cached = &*it;
+  return cached;
+}
+
+std::string const*
+SymbolTable::find(std::string_view name)
+{
+  Shard& shard = get_shard(NameHash()(name));
+  std::shared_lock<std::shared_mutex> lock(shard.mutex);
+  auto it = shard.names.find(name);
+  return it != shard.names.end() ? &*it : nullptr;
+}
+
+size_t
+SymbolTable::size()
+{
+  size_t result = 0;
+  for(size_t i = 0; i < NUM_SHARDS; ++i)
+  {
+    std::shared_lock<std::shared_mutex> lock(get_shards()[i].mutex);
+    result += get_shards()[i].names.size();
+  }
+  return result;
+}
+
+void
+SymbolTable::set_max_size(size_t max_size)
+{
+  g_max_size.store(max_size, std::memory_order_relaxed);
+}
+
+size_t
+SymbolTable::get_max_size()
+{
+  return g_max_size.load(std::memory_order_relaxed);
+}
+
+} // namespace sexp
+
+/* EOF */
@@ -0,0 +1,595 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sexp/tape_document.hpp"
+
+#include <assert.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "sexp/event_parser.hpp"
+#include "sexp/lexer.hpp"
+#include "mapped_file.hpp"
+
+namespace sexp {
+
+/** Appends nodes as the events of EventParser come in, Values are
+    converted by reporting them as the same events */
+class TapeDocument::Builder : public EventHandler
+{
+public:
+  Builder(TapeDocument& doc) :
+    m_doc(doc),
+    m_open()
+  {
+    // the list of top level forms
+    on_list_begin(0);
+  }
+
+  TapeDocument finish()
+  {
+    on_list_end(0);
+    return std::move(m_doc);
+  }
+
+  void on_list_begin(int line) { m_open.push_back(add(Value::Type::CONS, line)); }
+  void on_list_end(int /*line*/) { close(); }
+  void on_array_begin(int line) { m_open.push_back(add(Value::Type::ARRAY, line)); }
+  void on_array_end(int /*line*/) { close(); }
+
+  void on_dot(int /*line*/)
+  {
+    m_doc.m_nodes[m_open.back()].flags |= DOTTED;
+  }
+
+  void on_symbol(std::string_view value, int line) { add_string(Value::Type::SYMBOL, value, line); }
+  void on_string(std::string_view value, int line) { add_string(Value::Type::STRING, value, line); }
+  void on_integer(int value, int line) { m_doc.m_nodes[add(Value::Type::INTEGER, line)].integer = value; }
+  void on_real(float value, int line) { m_doc.m_nodes[add(Value::Type::REAL, line)].real = value; }
+  void on_bool(bool value, int line) { m_doc.m_nodes[add(Value::Type::BOOLEAN, line)].boolean = value; }
+
+  void add_value(Value const& value);
+
+private:
+  uint32_t add(Value::Type type, int line)
+  {
+    if (m_doc.m_nodes.size() >= UINT32_MAX)
+    {
+      throw std::runtime_error("sexp::TapeDocument: too many nodes");
+    }
+
+    if (!m_open.empty())
+    {
+      Node& parent = m_doc.m_nodes[m_open.back()];
+      if (!(parent.flags & DOTTED))
+      {
+        parent.length += 1;
+      }
+    }
+
+    uint32_t const idx = static_cast<uint32_t>(m_doc.m_nodes.size());
+    Node node;
+    node.type = type;
+    node.flags = 0;
+    node.next = 1;
+    node.length = 0;
+    node.offset = 0;
+    m_doc.m_nodes.push_back(node);
+    m_doc.m_lines.push_back(line);
+    return idx;
+  }
+
+  void add_string(Value::Type type, std::string_view value, int line)
+  {
+    if (m_doc.m_strings.size() + value.size() > UINT32_MAX)
+    {
+      throw std::runtime_error("sexp::TapeDocument: string data larger than 4GB");
+    }
+
+    Node& node = m_doc.m_nodes[add(type, line)];
+    node.length = static_cast<uint32_t>(value.size());
+    node.offset = static_cast<uint32_t>(m_doc.m_strings.size());
+    m_doc.m_strings.append(value);
+  }
+
+  void close()
+  {
+    uint32_t const idx = m_open.back();
+    m_open.pop_back();
+
+    Node& node = m_doc.m_nodes[idx];
+    node.next = static_cast<uint32_t>(m_doc.m_nodes.size()) - idx;
+    if (node.type == Value::Type::CONS && node.length == 0)
+    {
+      // "()" is nil, same as in Value
+      node.type = Value::Type::NIL;
+    }
+  }
+
+private:
+  TapeDocument& m_doc;
+
+  /** Lists and arrays whose end hasn't been seen yet */
+  std::vector<uint32_t> m_open;
+};
+
+void
+TapeDocument::Builder::add_value(Value const& value)
+{
+  // the rest of each open list or the position in each open array,
+  // walked without recursion like Parser
+  struct Frame
+  {
+    bool array;
+    Value const* rest;
+    size_t idx;
+  };
+  std::vector<Frame> stack;
+
+  Value const* cur = &value;
+  while(true)
+  {
+    switch(cur->get_type())
+    {
+      case Value::Type::NIL:
+        add(Value::Type::NIL, cur->get_line());
+        break;
+
+      case Value::Type::BOOLEAN:
+        on_bool(cur->as_bool(), cur->get_line());
+        break;
+
+      case Value::Type::INTEGER:
+        on_integer(cur->as_int(), cur->get_line());
+        break;
+
+      case Value::Type::REAL:
+        on_real(cur->as_float(), cur->get_line());
+        break;
+
+      case Value::Type::STRING:
+        on_string(cur->as_string_view(), cur->get_line());
+        break;
+
+      case Value::Type::SYMBOL:
+        on_symbol(cur->as_string_view(), cur->get_line());
+        break;
+
+      case Value::Type::CONS:
+        on_list_begin(cur->get_line());
+        stack.push_back(Frame{false, cur, 0});
+        break;
+
+      case Value::Type::ARRAY:
+        on_array_begin(cur->get_line());
+        stack.push_back(Frame{true, cur, 0});
+        break;
+
+      case Value::Type::INT_ARRAY:
+        on_array_begin(cur->get_line());
+        for(int item : cur->as_int_array()) {
+          on_integer(item, cur->get_line());
+        }
+        on_array_end(0);
+        break;
+
+      case Value::Type::REAL_ARRAY:
+        on_array_begin(cur->get_line());
+        for(float item : cur->as_real_array()) {
+          on_real(item, cur->get_line());
+        }
+        on_array_end(0);
+        break;
+    }
+
+    // find the next element, closing the lists and arrays that are done
+    cur = nullptr;
+    while(!cur && !stack.empty())
+    {
+      Frame& frame = stack.back();
+      if (frame.array)
+      {
+        auto const& arr = frame.rest->as_array();
+        if (frame.idx < arr.size())
+        {
+          cur = &arr[frame.idx];
+          frame.idx += 1;
+        }
+        else
+        {
+          on_array_end(0);
+          stack.pop_back();
+        }
+      }
+      else if (frame.rest->is_cons())
+      {
+        cur = &frame.rest->get_car();
+        frame.rest = &frame.rest->get_cdr();
+      }
+      else if (frame.rest->is_nil())
+      {
+        on_list_end(0);
+        stack.pop_back();
+      }
+      else
+      {
+        // the cdr of a dotted list
+        on_dot(0);
+        cur = frame.rest;
+        frame.rest = &Value::nil_ref();
+      }
+    }
+
+    if (!cur)
+    {
+      return;
+    }
+  }
+}
+
+TapeDocument::TapeDocument() :
+  m_nodes(),
+  m_lines(),
+  m_strings()
+{
+}
+
+TapeDocument
+TapeDocument::from_string_view(std::string_view str, bool use_arrays)
+{
+  TapeDocument doc;
+  Builder builder(doc);
+  EventParser<Builder>::from_string_view(str, builder, use_arrays);
+  return builder.finish();
+}
+
+TapeDocument
+TapeDocument::from_stream(std::istream& stream, bool use_arrays)
+{
+  TapeDocument doc;
+  Builder builder(doc);
+  EventParser<Builder>::from_stream(stream, builder, use_arrays);
+  return builder.finish();
+}
+
+TapeDocument
+TapeDocument::from_file(std::string const& filename, bool use_arrays)
+{
+  MappedFile file(filename);
+  if (file.is_mapped())
+  {
+    return from_string_view(file.get_data(), use_arrays);
+  }
+  else
+  {
+    std::ifstream fin(filename, std::ios::binary);
+    if (!fin)
+    {
+      throw std::runtime_error("failed to open " + filename);
+    }
+    return from_stream(fin, use_arrays);
+  }
+}
+
+TapeDocument
+TapeDocument::from_value(Value const& value)
+{
+  TapeDocument doc;
+  Builder builder(doc);
+  builder.add_value(value);
+  return builder.finish();
+}
+
+NodeRef
+TapeDocument::get_root() const
+{
+  NodeRef const forms = get_forms();
+  return forms.is_cons() ? forms.get_car() : NodeRef();
+}
+
+NodeRef
+TapeDocument::get_forms() const
+{
+  return make_element(0);
+}
+
+int
+NodeRef::get_line() const
+{
+  if (!m_doc)
+  {
+    return 0;
+  }
+  else if (m_list != NO_LIST && m_idx == m_list + 1)
+  {
+    return m_doc->m_lines[m_list];
+  }
+  else
+  {
+    return m_doc->m_lines[m_idx];
+  }
+}
+
+void
+NodeRef::type_error(const char* msg) const
+{
+  throw TypeError(get_line(), msg);
+}
+
+bool
+NodeRef::as_bool() const
+{
+  if (!is_boolean())
+  {
+    type_error("sexp::NodeRef::as_bool(): wrong type, expected Type::BOOLEAN");
+  }
+  return m_doc->m_nodes[m_idx].boolean;
+}
+
+float
+NodeRef::as_float() const
+{
+  if (is_integer())
+  {
+    return static_cast<float>(m_doc->m_nodes[m_idx].integer);
+  }
+  else if (get_type() == Value::Type::REAL)
+  {
+    return m_doc->m_nodes[m_idx].real;
+  }
+  else
+  {
+    type_error("sexp::NodeRef::as_float(): wrong type, expected Type::INTEGER or Type::REAL");
+  }
+}
+
+std::string_view
+NodeRef::as_string_view() const
+{
+  if (!is_string() && !is_symbol())
+  {
+    type_error("sexp::NodeRef::as_string_view(): wrong type, expected Type::SYMBOL or Type::STRING");
+  }
+  TapeDocument::Node const& node = m_doc->m_nodes[m_idx];
+  return std::string_view(m_doc->m_strings).substr(node.offset, node.length);
+}
+
+int
+NodeRef::get_array_size() const
+{
+  if (!is_array())
+  {
+    type_error("sexp::NodeRef::get_array_size(): wrong type, expected Type::ARRAY");
+  }
+  return static_cast<int>(m_doc->m_nodes[m_idx].length);
+}
+
+NodeRef
+NodeRef::array_ref(int index) const
+{
+  if (index < 0 || index >= get_array_size())
+  {
+    throw std::out_of_range("sexp::NodeRef::array_ref(): index out of range");
+  }
+
+  uint32_t idx = m_idx + 1;
+  for(int i = 0; i < index; ++i)
+  {
+    idx += m_doc->m_nodes[idx].next;
+  }
+  return m_doc->make_element(idx);
+}
+
+bool
+NodeRef::is_symbol(std::string_view name) const
+{
+  return is_symbol() && as_string_view() == name;
+}
+
+Value
+NodeRef::to_value() const
+{
+  if (!m_doc)
+  {
+    return Value();
+  }
+
+  // the nodes of a subtree are contiguous, so they are simply visited
+  // in order with a frame for every open list or array
+  struct Frame
+  {
+    uint32_t end;
+    bool array;
+    bool dotted;
+    int line;
+    Value list;
+    Value* tail;
+    std::vector<Value> elements;
+  };
+  std::vector<Frame> stack;
+
+  std::vector<TapeDocument::Node> const& nodes = m_doc->m_nodes;
+  uint32_t idx = m_idx;
+  if (m_list != NO_LIST)
+  {
+    stack.push_back(Frame{m_list + nodes[m_list].next, false, (nodes[m_list].flags & TapeDocument::DOTTED) != 0,
+                          get_line(), Value(), nullptr, {}});
+  }
+
+  while(true)
+  {
+    TapeDocument::Node const& node = nodes[idx];
+    int const line = m_doc->m_lines[idx];
+    idx += 1;
+
+    Value result;
+    switch(node.type)
+    {
+      case Value::Type::NIL:
+        break;
+
+      case Value::Type::BOOLEAN:
+        result = Value::boolean(node.boolean);
+        break;
+
+      case Value::Type::INTEGER:
+        result = Value::integer(node.integer);
+        break;
+
+      case Value::Type::REAL:
+        result = Value::real(node.real);
+        break;
+
+      case Value::Type::STRING:
+        result = Value::string(std::string_view(m_doc->m_strings).substr(node.offset, node.length));
+        break;
+
+      case Value::Type::SYMBOL:
+        result = Value::symbol(std::string_view(m_doc->m_strings).substr(node.offset, node.length));
+        break;
+
+      case Value::Type::INT_ARRAY:
+      case Value::Type::REAL_ARRAY:
+        assert(false && "typed arrays are stored as ARRAY nodes");
+        break;
+
+      case Value::Type::CONS:
+      case Value::Type::ARRAY:
+        stack.push_back(Frame{idx - 1 + node.next, node.type == Value::Type::ARRAY,
+                              (node.flags & TapeDocument::DOTTED) != 0, line, Value(), nullptr, {}});
+        if (idx != stack.back().end)
+        {
+          stack.back().elements.reserve(node.type == Value::Type::ARRAY ? node.length : 0);
+          continue;
+        }
+        else
+        {
+          // "#()", lists are never empty
+          stack.pop_back();
+          result = Value::array(std::vector<Value>());
+        }
+        break;
+    }
+    result.set_line(line);
+
+    // hand the value to the enclosing list or array, finishing all of
+    // those that end with it
+    while(!stack.empty())
+    {
+      Frame& frame = stack.back();
+      if (frame.array)
+      {
+        frame.elements.push_back(std::move(result));
+      }
+      else if (frame.dotted && idx == frame.end)
+      {
+        (frame.tail ? *frame.tail : frame.list).set_cdr(std::move(result));
+      }
+      else if (frame.list.is_nil())
+      {
+        frame.list = Value::cons(std::move(result), Value::nil());
+      }
+      else
+      {
+        Value& tail = frame.tail ? *frame.tail : frame.list;
+        tail.set_cdr(Value::cons(std::move(result), Value::nil()));
+        frame.tail = &tail.get_cdr();
+      }
+
+      if (idx != frame.end)
+      {
+        break;
+      }
+
+      result = frame.array ? Value::array(std::move(frame.elements)) : std::move(frame.list);
+      result.set_line(frame.line);
+      stack.pop_back();
+    }
+
+    if (stack.empty())
+    {
+      return result;
+    }
+  }
+}
+
+bool
+is_list(NodeRef const& sx)
+{
+  NodeRef cur = sx;
+  while(cur.is_cons())
+  {
+    cur = cur.get_cdr();
+  }
+  return cur.is_nil();
+}
+
+int
+list_length(NodeRef const& sx)
+{
+  int length = 0;
+  NodeRef cur = sx;
+  while(cur.is_cons())
+  {
+    length += 1;
+    cur = cur.get_cdr();
+  }
+
+  if (!cur.is_nil())
+  {
+    throw TypeError(cur.get_line(), "sexp::list_length(): wrong type, expected list");
+  }
+  return length;
+}
+
+NodeRef
+list_ref(NodeRef const& sx, int index)
+{
+  NodeRef cur = sx;
+  for(int i = 0; i < index; ++i)
+  {
+    cur = cur.get_cdr();
+  }
+  return cur.get_car();
+}
+
+NodeRef
+assoc_ref(NodeRef const& sx, std::string_view key)
+{
+  NodeRef cur = sx;
+  while(cur.is_cons())
+  {
+    NodeRef const pair = cur.get_car();
+    if (pair.is_cons() && pair.get_car().is_symbol(key))
+    {
+      return pair.get_cdr();
+    }
+    cur = cur.get_cdr();
+  }
+
+  if (!cur.is_nil())
+  {
+    std::ostringstream msg;
+    msg << "malformed input to sexp::assoc_ref(): key:\"" << key << "\"";
+    throw std::runtime_error(msg.str());
+  }
+  return NodeRef();
+}
+
+} // namespace sexp
+
+/* EOF */
@@ -72,8 +72,10 @@ list_ref(Value const& sx, int index)
   }
 }
 
+namespace {
+
 Value const&
-assoc_ref(Value const& sx, std::string const& key)
+assoc_ref_symbol(Value const& sx, std::string const& key, Value const& symbol)
 {
   if (sx.is_nil())
   {
@@ -82,15 +84,20 @@ assoc_ref(Value const& sx, std::string const& key)
   else if (sx.is_cons())
   {
     Value const& pair = sx.get_car();
+    // a key that isn't in the SymbolTable can only match a symbol
+    // that didn't fit into it, otherwise Value::operator==() compares
+    // interned symbols by address and the others by name
     if (pair.is_cons() &&
         pair.get_car().is_symbol() &&
-        pair.get_car().as_string() == key)
+        (symbol.is_nil() ?
+         pair.get_car().as_string_view() == key :
+         pair.get_car() == symbol))
     {
       return pair.get_cdr();
     }
     else
     {
-      return assoc_ref(sx.get_cdr(), key);
+      return assoc_ref_symbol(sx.get_cdr(), key, symbol);
     }
   }
   else
@@ -101,6 +108,17 @@ assoc_ref(Value const& sx, std::string const& key)
   }
 }
 
+} // namespace
+
+Value const&
+assoc_ref(Value const& sx, std::string const& key)
+{
+  // looking up the key must not add it to the table, creating the
+  // symbol only looks up a name that is already there
+  Value const symbol = SymbolTable::find(key) ? Value::symbol(key) : Value::nil();
+  return assoc_ref_symbol(sx, key, symbol);
+}
+
 } // namespace sexp
 
 /* EOF */
@@ -23,6 +23,165 @@
 
 namespace sexp {
 
+namespace {
+
+/** Shared nodes live on the heap, so the payload of an arena or
+    memory_resource Value is copied to the default resource, the one
+    of a heap Value is taken over as it is */
+template<typename T>
+T take_payload(T& payload, bool heap)
+{
+  if (heap) {
+    return std::move(payload);
+  } else {
+    return T(std::make_move_iterator(payload.begin()), std::make_move_iterator(payload.end()),
+             std::pmr::get_default_resource());
+  }
+}
+
+} // namespace
+
+void
+Value::share()
+{
+  // cdr chains are followed in a loop, cars and array elements are
+  // remembered for later, subtrees that are already shared are left
+  // alone
+  std::vector<Value*> pending;
+  Value* cur = this;
+
+  while(true)
+  {
+    int const line = cur->get_line();
+    if (cur->is_shared())
+    {
+      // nothing to do
+    }
+    else if (cur->type() == Type::STRING && cur->storage() == ARENA)
+    {
+      ArenaString* str = cur->arena_string_ptr();
+      auto* node = Pool::create<Shared<String> >(String(std::string_view(*str)));
+      release(str, ARENA);
+      cur->set_string(node, SHARED);
+      cur->set_line(line);
+    }
+    else if (cur->type() == Type::STRING && cur->storage() != INLINE)
+    {
+      String* str = cur->string_ptr();
+      auto* node = Pool::create<Shared<String> >(std::move(*str));
+      release(str, HEAP);
+      cur->set_string(node, SHARED);
+      cur->set_line(line);
+    }
+    else if (cur->type() == Type::SYMBOL && cur->storage() != INLINE)
+    {
+      String* str = cur->string_ptr();
+      auto* node = Pool::create<Shared<String> >(std::move(*str));
+      release(str, HEAP);
+      cur->set_symbol(node, SHARED);
+      cur->set_line(line);
+    }
+    else if (cur->type() == Type::INT_ARRAY)
+    {
+      IntArray* arr = cur->int_array_ptr();
+      auto* node = Pool::create<Shared<IntArray> >(take_payload(*arr, cur->storage() == HEAP));
+      release(arr, cur->storage());
+      cur->set_int_array(node, SHARED);
+      cur->set_line(line);
+    }
+    else if (cur->type() == Type::REAL_ARRAY)
+    {
+      RealArray* arr = cur->real_array_ptr();
+      auto* node = Pool::create<Shared<RealArray> >(take_payload(*arr, cur->storage() == HEAP));
+      release(arr, cur->storage());
+      cur->set_real_array(node, SHARED);
+      cur->set_line(line);
+    }
+    else if (cur->type() == Type::CONS)
+    {
+      Cons* cell = cur->cons_ptr();
+      auto* node = Pool::create<Shared<Cons> >(std::move(*cell));
+      release(cell, cur->storage());
+      cur->set_cons(node, SHARED);
+      cur->set_line(line);
+
+      pending.push_back(&node->car);
+      cur = &node->cdr;
+      continue;
+    }
+    else if (cur->type() == Type::ARRAY)
+    {
+      Array* arr = cur->array_ptr();
+      auto* node = Pool::create<Shared<Array> >(take_payload(*arr, cur->storage() == HEAP));
+      release(arr, cur->storage());
+      cur->set_array(node, SHARED);
+      cur->set_line(line);
+
+      for(Value& item : *node) {
+        pending.push_back(&item);
+      }
+    }
+
+    if (pending.empty())
+    {
+      break;
+    }
+    cur = pending.back();
+    pending.pop_back();
+  }
+}
+
+void
+Value::make_generic_array()
+{
+  if (type() == Type::INT_ARRAY || type() == Type::REAL_ARRAY)
+  {
+    int const line = get_line();
+    std::vector<Value> arr;
+    size_t const size = static_cast<size_t>(get_array_size());
+    arr.reserve(size);
+    for(size_t i = 0; i < size; ++i)
+    {
+      arr.push_back(array_element(i));
+      arr.back().set_line(line);
+    }
+
+    Value generic = Value::array(std::move(arr));
+    generic.set_line(line);
+    *this = std::move(generic);
+  }
+  else if (type() != Type::ARRAY)
+  {
+    type_error("sexp::Value::make_generic_array(): wrong type, expected Type::ARRAY");
+  }
+}
+
+bool
+Value::array_equal(Value const& other) const
+{
+  if (type() == Type::ARRAY)
+  {
+    // only one of them can be a generic array
+    return other.array_equal(*this);
+  }
+  else if (get_array_size() != other.get_array_size())
+  {
+    return false;
+  }
+
+  for(size_t i = 0; i < static_cast<size_t>(get_array_size()); ++i)
+  {
+    Value const element = array_element(i);
+    if (other.type() == Type::ARRAY ?
+        !element.shallow_equal((*other.array_ptr())[i]) :
+        !element.shallow_equal(other.array_element(i)))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
 std::string
 Value::str() const
 {
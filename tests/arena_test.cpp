@@ -0,0 +1,249 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <memory_resource>
+#include <stdint.h>
+
+#include "sexp/arena.hpp"
+#include "sexp/parser.hpp"
+#include "sexp/value.hpp"
+
+TEST(ArenaTest, allocate)
+{
+  sexp::Arena arena(256);
+  char* prev = static_cast<char*>(arena.allocate(1, 1));
+  for(int i = 0; i < 100; ++i)
+  {
+    char* p = static_cast<char*>(arena.allocate(8, 8));
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(p) % 8);
+    ASSERT_NE(prev, p);
+    prev = p;
+  }
+
+  // oversized allocations get their own chunk
+  size_t const capacity = arena.get_capacity();
+  char* big = static_cast<char*>(arena.allocate(4096, 16));
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(big) % 16);
+  ASSERT_LE(capacity + 4096, arena.get_capacity());
+}
+
+TEST(ArenaTest, values)
+{
+  sexp::Arena arena;
+  std::string const long_text(100, 'x');
+  sexp::Value value = sexp::Value::cons(sexp::Value::string(long_text, arena),
+                                        sexp::Value::cons(sexp::Value::symbol("foo", arena),
+                                                          sexp::Value::array(std::vector<sexp::Value>{sexp::Value::integer(5)}, arena),
+                                                          arena),
+                                        arena);
+  sexp::Value const expected = sexp::Value::cons(sexp::Value::string(long_text),
+                                                 sexp::Value::cons(sexp::Value::symbol("foo"),
+                                                                   sexp::Value::array(sexp::Value::integer(5))));
+  ASSERT_EQ(expected, value);
+
+  // the characters and elements are in the arena as well
+  sexp::Arena small(256);
+  char const* const chunk = static_cast<char const*>(small.allocate(1, 1));
+  auto const in_chunk = [&](void const* p) {
+    return std::less_equal<void const*>()(chunk, p) && std::less<void const*>()(p, chunk + 256);
+  };
+  sexp::Value const str = sexp::Value::string(std::string(50, 'y'), small);
+  sexp::Value const ints = sexp::Value::int_array({1, 2, 3}, small);
+  ASSERT_TRUE(in_chunk(str.as_string_view().data()));
+  ASSERT_TRUE(in_chunk(ints.as_int_array().data()));
+  ASSERT_EQ(256u, small.get_capacity());
+
+  // as_string() copies, the characters stay in the arena
+  ASSERT_EQ(std::string(50, 'y'), str.as_string());
+  ASSERT_TRUE(in_chunk(str.as_string_view().data()));
+
+  // heap values can be mixed into arena values and the other way around
+  value.set_car(sexp::Value::string(long_text));
+  sexp::Value heap = sexp::Value::cons(std::move(value.get_cdr()), sexp::Value::nil());
+  ASSERT_EQ(sexp::Value::symbol("foo"), heap.get_car().get_car());
+}
+
+TEST(ArenaTest, memory_resource)
+{
+  char buffer[4096];
+  std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+  std::string const long_text(100, 'x');
+  sexp::Value value = sexp::Value::cons(sexp::Value::string(long_text, resource),
+                                        sexp::Value::cons(sexp::Value::symbol("foo"),
+                                                          sexp::Value::array(std::vector<sexp::Value>{sexp::Value::integer(5)}, resource),
+                                                          resource),
+                                        resource);
+  ASSERT_EQ(sexp::Value::cons(sexp::Value::string(long_text),
+                              sexp::Value::cons(sexp::Value::symbol("foo"),
+                                                sexp::Value::array(sexp::Value::integer(5)))),
+            value);
+
+  // the nodes live in the buffer, copies of them on the heap
+  auto const in_buffer = [&](void const* p) {
+    return std::less_equal<void const*>()(buffer, p) && std::less<void const*>()(p, buffer + sizeof(buffer));
+  };
+  ASSERT_TRUE(in_buffer(&value.get_car()));
+  ASSERT_TRUE(in_buffer(value.get_car().as_string_view().data()));
+  ASSERT_TRUE(in_buffer(value.get_cdr().get_cdr().as_array().data()));
+  sexp::Value copy = value;
+  ASSERT_FALSE(in_buffer(&copy.get_car()));
+  ASSERT_EQ(copy, value);
+}
+
+namespace {
+
+/** Forwards to the default resource and keeps track of what is still
+    allocated */
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+  size_t allocations = 0;
+  size_t bytes = 0;
+
+private:
+  void* do_allocate(size_t size, size_t alignment) override
+  {
+    allocations += 1;
+    bytes += size;
+    return std::pmr::get_default_resource()->allocate(size, alignment);
+  }
+
+  void do_deallocate(void* ptr, size_t size, size_t alignment) override
+  {
+    allocations -= 1;
+    bytes -= size;
+    std::pmr::get_default_resource()->deallocate(ptr, size, alignment);
+  }
+
+  bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+  {
+    return this == &other;
+  }
+};
+
+} // namespace
+
+TEST(ArenaTest, memory_resource_deallocate)
+{
+  CountingResource resource;
+  std::string const text = "(foo (\"a long string that does not fit\" 1) #(2 (bar \"another long string\")))";
+  for(bool use_arrays : { false, true })
+  {
+    {
+      sexp::Value value = sexp::Value::cons(sexp::Value::int_array({1, 2, 3}, resource),
+                                            sexp::Parser::from_string(text, resource, use_arrays),
+                                            resource);
+      ASSERT_LT(0u, resource.allocations);
+      ASSERT_EQ(sexp::Value::cons(sexp::Value::int_array({1, 2, 3}), sexp::Parser::from_string(text, use_arrays)),
+                value);
+    }
+    ASSERT_EQ(0u, resource.allocations);
+    ASSERT_EQ(0u, resource.bytes);
+
+    // shared nodes are copied out of the resource
+    {
+      sexp::Value value = sexp::Parser::from_string(text, resource, use_arrays);
+      value.share();
+      ASSERT_EQ(0u, resource.allocations);
+      sexp::Value copy = value;
+      value = sexp::Value::nil();
+      ASSERT_EQ(sexp::Parser::from_string(text, use_arrays), copy);
+    }
+    ASSERT_EQ(0u, resource.allocations);
+    ASSERT_EQ(0u, resource.bytes);
+  }
+}
+
+TEST(ArenaTest, copy_outlives_arena)
+{
+  sexp::Value copy;
+  {
+    sexp::Arena arena;
+    sexp::Value value = sexp::Parser::from_string("(foo (\"a long string that does not fit\" 1) #(2 (bar)))",
+                                                  arena, sexp::Parser::USE_ARRAYS);
+    copy = value;
+  }
+  ASSERT_EQ(sexp::Parser::from_string("(foo (\"a long string that does not fit\" 1) #(2 (bar)))",
+                                      sexp::Parser::USE_ARRAYS),
+            copy);
+}
+
+TEST(ArenaTest, shared_copy_outlives_arena)
+{
+  std::string const long_text(100, 'x');
+  sexp::Value copy;
+  {
+    sexp::Arena arena;
+    sexp::Value value = sexp::Value::cons(sexp::Value::string(long_text, arena),
+                                          sexp::Value::cons(sexp::Value::int_array({1, 2, 3}, arena),
+                                                            sexp::Value::array(std::vector<sexp::Value>{sexp::Value::string(long_text, arena)},
+                                                                               arena),
+                                                            arena),
+                                          arena);
+    value.share();
+    copy = value;
+  }
+  ASSERT_EQ(sexp::Value::cons(sexp::Value::string(long_text),
+                              sexp::Value::cons(sexp::Value::int_array({1, 2, 3}),
+                                                sexp::Value::array(sexp::Value::string(long_text)))),
+            copy);
+  ASSERT_EQ("(\"" + long_text + "\" #(1 2 3) . #(\"" + long_text + "\"))", copy.str());
+}
+
+TEST(ArenaTest, deep_nesting)
+{
+  int const depth = 100000;
+  std::string const text = std::string(depth, '(') + "x" + std::string(depth, ')');
+  sexp::Arena arena;
+  sexp::Value value = sexp::Parser::from_string(text, arena);
+  sexp::Value copy = value;
+  ASSERT_EQ(copy, value);
+
+  // destroying a tree that mixes arena and heap cells
+  value.set_cdr(std::move(copy));
+}
+
+TEST(ArenaTest, clear)
+{
+  sexp::Arena arena(256);
+  for(int i = 0; i < 100; ++i) {
+    arena.allocate(16, 8);
+  }
+  arena.allocate(4096, 16);
+  ASSERT_LT(256u + 4096u, arena.get_capacity());
+
+  // a single regular chunk survives
+  arena.clear();
+  ASSERT_EQ(256u, arena.get_capacity());
+  char* p = static_cast<char*>(arena.allocate(16, 8));
+  ASSERT_NE(nullptr, p);
+  ASSERT_EQ(256u, arena.get_capacity());
+
+  sexp::Arena empty;
+  empty.clear();
+  ASSERT_EQ(0u, empty.get_capacity());
+  ASSERT_NE(nullptr, empty.allocate(8, 8));
+
+  {
+    sexp::Value value = sexp::Parser::from_string("(foo \"a long string that does not fit\" 1)", arena);
+  }
+  arena.clear();
+  ASSERT_EQ(sexp::Parser::from_string("(bar 2)"), sexp::Parser::from_string("(bar 2)", arena));
+}
+
+/* EOF */
@@ -0,0 +1,209 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <coroutine>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sexp/async_parser.hpp"
+#include "sexp/parser.hpp"
+#include "sexp/value.hpp"
+
+namespace {
+
+/** Source that suspends the reader until data is written */
+class PipeSource
+{
+public:
+  PipeSource() : m_data(), m_closed(false), m_waiting() {}
+
+  void write(std::string_view data)
+  {
+    m_data += data;
+    resume();
+  }
+
+  void close()
+  {
+    m_closed = true;
+    resume();
+  }
+
+  bool is_waiting() const { return static_cast<bool>(m_waiting); }
+
+  auto read(std::span<char> buffer)
+  {
+    struct Awaiter
+    {
+      PipeSource& pipe;
+      std::span<char> buffer;
+
+      bool await_ready() const noexcept { return !pipe.m_data.empty() || pipe.m_closed; }
+      void await_suspend(std::coroutine_handle<> handle) noexcept { pipe.m_waiting = handle; }
+      size_t await_resume()
+      {
+        size_t const size = std::min(buffer.size(), pipe.m_data.size());
+        pipe.m_data.copy(buffer.data(), size);
+        pipe.m_data.erase(0, size);
+        return size;
+      }
+    };
+    return Awaiter{*this, buffer};
+  }
+
+private:
+  void resume()
+  {
+    if (std::coroutine_handle<> handle = std::exchange(m_waiting, nullptr)) {
+      handle.resume();
+    }
+  }
+
+private:
+  std::string m_data;
+  bool m_closed;
+  std::coroutine_handle<> m_waiting;
+};
+
+sexp::Task<int> consume(PipeSource& pipe, std::vector<sexp::Value>& values)
+{
+  sexp::AsyncParser<PipeSource> parser(pipe, false, 8);
+  sexp::Value value;
+  while(co_await parser.next(value)) {
+    values.push_back(std::move(value));
+  }
+  co_return static_cast<int>(values.size());
+}
+
+/** read() is a coroutine of its own */
+struct TaskSource
+{
+  sexp::Task<size_t> read(std::span<char>);
+};
+
+/** read() results in the wrong type */
+struct StringReadSource
+{
+  std::string_view read(std::span<char>) { return {}; }
+};
+
+/** read() isn't awaitable at all */
+struct SyncSource
+{
+  size_t read(std::span<char>) { return 0; }
+};
+
+} // namespace
+
+static_assert(sexp::AsyncByteSource<sexp::StringSource>);
+static_assert(sexp::AsyncByteSource<PipeSource>);
+static_assert(sexp::AsyncByteSource<TaskSource>);
+static_assert(!sexp::AsyncByteSource<StringReadSource>);
+static_assert(!sexp::AsyncByteSource<SyncSource>);
+
+TEST(AsyncParserTest, string_source)
+{
+  std::string const text = "(a 1)\n\n b \"c\" ; comment\n #(1 2) (d (e . f)) 5";
+  std::vector<sexp::Value> const expected = sexp::Parser::from_string_many(text);
+
+  sexp::StringSource source(text);
+  sexp::Task<std::vector<sexp::Value>> task = sexp::read_many_async(source);
+  task.start();
+  ASSERT_TRUE(task.done());
+  std::vector<sexp::Value> const result = task.get();
+  ASSERT_EQ(expected.size(), result.size());
+  for(size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[i], result[i]);
+    ASSERT_EQ(expected[i].get_line(), result[i].get_line());
+  }
+
+  // a default constructed string_view has no data() to copy from
+  sexp::StringSource empty{std::string_view()};
+  sexp::Task<std::vector<sexp::Value>> empty_task = sexp::read_many_async(empty);
+  empty_task.start();
+  ASSERT_TRUE(empty_task.get().empty());
+}
+
+TEST(AsyncParserTest, pipe_source)
+{
+  PipeSource pipe;
+  std::vector<sexp::Value> values;
+  sexp::Task<int> task = consume(pipe, values);
+
+  task.start();
+  ASSERT_TRUE(pipe.is_waiting());
+
+  pipe.write("(a \"long string that takes");
+  ASSERT_TRUE(values.empty());
+  pipe.write(" a few reads\") (b");
+  ASSERT_EQ(1, values.size());
+  ASSERT_EQ("(a \"long string that takes a few reads\")", values[0].str());
+  pipe.write(" 2) 12");
+  ASSERT_EQ(2, values.size());
+  ASSERT_FALSE(task.done());
+
+  pipe.close();
+  ASSERT_TRUE(task.done());
+  ASSERT_EQ(3, task.get());
+  ASSERT_EQ(12, values[2].as_int());
+}
+
+TEST(AsyncParserTest, errors)
+{
+  for(std::string_view text : { "", "(foo", "(foo) bar", "(foo))" })
+  {
+    sexp::StringSource source(text);
+    sexp::Task<sexp::Value> task = sexp::read_async(source);
+    task.start();
+    ASSERT_TRUE(task.done());
+    ASSERT_THROW(task.get(), std::runtime_error) << text;
+  }
+
+  // same messages as from Parser::from_stream()
+  for(std::string_view text : { "", " \n\n", "(foo\n", "(foo)\n\n bar", "(foo)\n(bar\n baz)" })
+  {
+    std::string expected;
+    try {
+      sexp::Parser::from_string_view(text);
+    } catch(std::runtime_error const& err) {
+      expected = err.what();
+    }
+    ASSERT_FALSE(expected.empty()) << text;
+
+    sexp::StringSource source(text);
+    sexp::Task<sexp::Value> task = sexp::read_async(source);
+    task.start();
+    try {
+      task.get();
+      FAIL() << text;
+    } catch(std::runtime_error const& err) {
+      ASSERT_EQ(expected, err.what());
+    }
+  }
+
+  sexp::StringSource source("(foo)");
+  sexp::Task<sexp::Value> task = sexp::read_async(source);
+  task.start();
+  ASSERT_EQ("(foo)", task.get().str());
+}
+
+/* EOF */
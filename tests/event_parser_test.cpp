@@ -0,0 +1,165 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "sexp/event_parser.hpp"
+#include "sexp/parser.hpp"
+#include "sexp/tape_document.hpp"
+#include "sexp/value.hpp"
+
+namespace {
+
+class TraceHandler : public sexp::EventHandler
+{
+public:
+  std::ostringstream out;
+
+  void on_list_begin(int line) { out << line << ":( "; }
+  void on_list_end(int line) { out << line << ":) "; }
+  void on_array_begin(int line) { out << line << ":#( "; }
+  void on_array_end(int line) { out << line << ":#) "; }
+  void on_dot(int line) { out << line << ":. "; }
+  void on_symbol(std::string_view value, int line) { out << line << ":" << value << " "; }
+  void on_string(std::string_view value, int line) { out << line << ":\"" << value << "\" "; }
+  void on_integer(int value, int line) { out << line << ":" << value << " "; }
+  void on_real(float value, int line) { out << line << ":" << value << "f "; }
+  void on_bool(bool value, int line) { out << line << ":" << (value ? "#t" : "#f") << " "; }
+};
+
+// only counts, to check that unhandled events fall back to EventHandler
+class CountHandler : public sexp::EventHandler
+{
+public:
+  int lists = 0;
+  int integers = 0;
+
+  void on_list_begin(int) { lists += 1; }
+  void on_integer(int, int) { integers += 1; }
+};
+
+std::string trace(std::string_view text, bool use_arrays = false)
+{
+  TraceHandler handler;
+  sexp::EventParser<TraceHandler>::from_string_view(text, handler, use_arrays);
+  return handler.out.str();
+}
+
+std::string error_message(std::function<void ()> func)
+{
+  try {
+    func();
+  } catch(std::runtime_error const& err) {
+    return err.what();
+  }
+  return "no error";
+}
+
+} // namespace
+
+TEST(EventParserTest, events)
+{
+  EXPECT_EQ("0:( 0:foo 0:\"bar\" 0:5 0:2.5f 0:#t 0:#f 0:( 0:a 0:. 0:b 0:) 1:) 1:( 1:) ",
+            trace("(foo \"bar\" 5 2.5 #t #f (a . b))\n()"));
+  EXPECT_EQ("0:#( 0:1 0:( 0:2 0:) 0:#) ", trace("#(1 (2))"));
+  EXPECT_EQ("0:#( 0:1 0:#( 0:2 0:#) 0:#) ", trace("(1 (2))", sexp::Parser::USE_ARRAYS));
+  EXPECT_EQ("", trace("  ; nothing\n"));
+}
+
+TEST(EventParserTest, line_numbers)
+{
+  class LineHandler : public sexp::EventHandler
+  {
+  public:
+    std::vector<int> lines;
+    void on_symbol(std::string_view, int line) { lines.push_back(line); }
+  };
+
+  std::string const text = "a\n\nb ; comment\n c\n\"multi\nline\" d\n";
+  LineHandler handler;
+  sexp::EventParser<LineHandler>::from_string_view(text, handler);
+
+  std::vector<int> expected;
+  for(sexp::Value const& value : sexp::Parser::from_string_many(text))
+  {
+    if (value.is_symbol()) {
+      expected.push_back(value.get_line());
+    }
+  }
+  EXPECT_EQ(expected, handler.lines);
+}
+
+TEST(EventParserTest, stream)
+{
+  std::istringstream in("(1 (2 3)) 4 (5)");
+  CountHandler handler;
+  sexp::EventParser<CountHandler>::from_stream(in, handler);
+  EXPECT_EQ(3, handler.lists);
+  EXPECT_EQ(5, handler.integers);
+}
+
+TEST(EventParserTest, read)
+{
+  sexp::Lexer lexer(std::string_view("(1 2) 3"));
+  CountHandler handler;
+  sexp::EventParser<CountHandler> parser(lexer, handler);
+  ASSERT_TRUE(parser.read());
+  EXPECT_EQ(2, handler.integers);
+  ASSERT_TRUE(parser.read());
+  EXPECT_EQ(3, handler.integers);
+  ASSERT_FALSE(parser.read());
+}
+
+TEST(EventParserTest, errors)
+{
+  // the same input is rejected with the same message as by Parser
+  for(std::string const text : { "(1 2", "(1 . 2 3)", "(. 1)", "(1 . )", ")", ".", "#(1 . 2)", "(1 . . 2)", "#()", "(#())" })
+  {
+    CountHandler handler;
+    std::string const expected = error_message([&]{ sexp::Parser::from_string_many(text); });
+    EXPECT_NE("no error", expected) << text;
+    EXPECT_EQ(expected, error_message([&]{ sexp::EventParser<CountHandler>::from_string_view(text, handler); })) << text;
+  }
+}
+
+TEST(EventParserTest, empty_array)
+{
+  // empty arrays are rejected the same way by every parser
+  for(bool use_arrays : {false, true})
+  {
+    std::string const text = use_arrays ? "(a ())" : "(a #())";
+    CountHandler handler;
+    std::string const expected = error_message([&]{ sexp::Parser::from_string(text, use_arrays); });
+    EXPECT_NE("no error", expected) << text;
+    EXPECT_EQ(expected, error_message([&]{ sexp::EventParser<CountHandler>::from_string_view(text, handler, use_arrays); })) << text;
+    EXPECT_EQ(expected, error_message([&]{ sexp::TapeDocument::from_string_view(text, use_arrays); })) << text;
+  }
+}
+
+TEST(EventParserTest, max_depth)
+{
+  sexp::Lexer lexer(std::string_view("((((1))))"));
+  CountHandler handler;
+  sexp::EventParser<CountHandler> parser(lexer, handler, 3);
+  ASSERT_THROW(parser.read(), std::runtime_error);
+}
+
+/* EOF */
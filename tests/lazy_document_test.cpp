@@ -0,0 +1,110 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "sexp/lazy_document.hpp"
+#include "sexp/parser.hpp"
+#include "sexp/util.hpp"
+#include "sexp/value.hpp"
+
+namespace {
+
+// walks both trees and compares every node built on demand with the
+// one built by the Parser
+void compare(sexp::Value const& expected, sexp::LazyValue const& lazy)
+{
+  ASSERT_EQ(expected, lazy.get());
+  ASSERT_EQ(expected.get_line(), lazy.get().get_line());
+  ASSERT_EQ(expected.is_nil(), lazy.is_nil());
+  ASSERT_EQ(expected.is_cons(), lazy.is_cons());
+  ASSERT_EQ(expected.is_array(), lazy.is_array());
+  if (expected.is_cons())
+  {
+    compare(expected.get_car(), lazy.get_car());
+    compare(expected.get_cdr(), lazy.get_cdr());
+  }
+}
+
+} // namespace
+
+TEST(LazyDocumentTest, navigation)
+{
+  std::string const text = "(level (name \"x\") ; (name \"y\")\n (size 10 . 20) ()\n (data #(1 2) \"a)\\\"b\"))\n(second)";
+  sexp::LazyDocument doc(text);
+  sexp::LazyValue const root = doc.get_root();
+
+  ASSERT_TRUE(root.get_car().is_symbol("level"));
+  ASSERT_FALSE(root.get_car().is_symbol("lev"));
+  ASSERT_EQ("x", sexp::assoc_ref(root.get_cdr(), "name").get_car().get().as_string());
+  ASSERT_EQ(20, sexp::assoc_ref(root.get_cdr(), "size").get_cdr().get().as_int());
+  ASSERT_TRUE(sexp::assoc_ref(root.get_cdr(), "missing").is_nil());
+  ASSERT_TRUE(sexp::assoc_ref(root.get_cdr(), "data").get_car().is_array());
+
+  std::vector<sexp::Value> const expected = sexp::Parser::from_string_many(text);
+  compare(expected[0], root);
+  compare(sexp::Value::list(sexp::Value(expected[0]), sexp::Value(expected[1])), doc.get_forms());
+
+  ASSERT_THROW(root.get_car().get_car(), sexp::TypeError);
+}
+
+TEST(LazyDocumentTest, from_file)
+{
+  sexp::LazyDocument doc = sexp::LazyDocument::from_file("benchmarks/test.sexp");
+  sexp::Value const expected = sexp::Parser::from_file("benchmarks/test.sexp");
+  ASSERT_EQ(expected, doc.get_root().get());
+
+  sexp::Value const* cur = &expected;
+  for(sexp::LazyValue lazy = doc.get_root(); !lazy.is_nil(); lazy = lazy.get_cdr())
+  {
+    ASSERT_EQ(cur->get_car(), lazy.get_car().get());
+    ASSERT_EQ(cur->get_car().get_line(), lazy.get_car().get().get_line());
+    cur = &cur->get_cdr();
+  }
+  ASSERT_TRUE(cur->is_nil());
+
+  sexp::LazyValue const sector = sexp::assoc_ref(doc.get_root().get_cdr(), "sector");
+  ASSERT_EQ(sexp::assoc_ref(expected.get_cdr(), "sector"), sector.get());
+}
+
+TEST(LazyDocumentTest, use_arrays)
+{
+  std::string const text = "(a (b 1) #(c))";
+  sexp::LazyDocument doc(text, sexp::Parser::USE_ARRAYS);
+  ASSERT_TRUE(doc.get_root().is_array());
+  ASSERT_EQ(sexp::Parser::from_string(text, sexp::Parser::USE_ARRAYS), doc.get_root().get());
+}
+
+TEST(LazyDocumentTest, errors)
+{
+  // structural errors are found right away
+  ASSERT_THROW(sexp::LazyDocument("(a (b)"), std::runtime_error);
+  ASSERT_THROW(sexp::LazyDocument("(a))"), std::runtime_error);
+  ASSERT_THROW(sexp::LazyDocument("(a \"b)"), std::runtime_error);
+
+  // everything else once it is accessed
+  sexp::LazyDocument doc("((a . b c) #z)");
+  ASSERT_NO_THROW(doc.get_root().get_car());
+  ASSERT_THROW(doc.get_root().get_car().get(), std::runtime_error);
+  ASSERT_THROW(doc.get_root().get_cdr().get_car().get(), std::runtime_error);
+
+  ASSERT_TRUE(sexp::LazyDocument("").get_root().is_nil());
+}
+
+/* EOF */
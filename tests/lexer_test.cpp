@@ -17,6 +17,8 @@
 #include <gtest/gtest.h>
 
 #include <sstream>
+#include <stdexcept>
+#include <utility>
 
 #include "sexp/lexer.hpp"
 
@@ -80,6 +82,12 @@ TEST(LexerTest, token_symbol)
     "foo-bar",
     "1.2.3",
     "e50",
+    "-a5",
+    "+",
+    "-.",
+    "1.e5",
+    "1e+",
+    "...",
   };
 
   for(const auto& text : texts)
@@ -115,11 +123,44 @@ TEST(LexerTest, token_integer)
   }
 }
 
+TEST(LexerTest, integer_value)
+{
+  std::vector<std::pair<std::string, int>> texts = {
+    { "0", 0 },
+    { "+17", 17 },
+    { "-0", 0 },
+    { "007", 7 },
+    { "2147483647", 2147483647 },
+    { "-2147483648", -2147483647 - 1 },
+  };
+
+  for(const auto& [text, value] : texts)
+  {
+    std::istringstream is(text);
+    sexp::Lexer lexer(is);
+    ASSERT_EQ(sexp::Lexer::TOKEN_INTEGER, lexer.get_next_token());
+    ASSERT_EQ(value, lexer.get_integer()) << text;
+
+    sexp::Lexer lexer_view(text);
+    ASSERT_EQ(sexp::Lexer::TOKEN_INTEGER, lexer_view.get_next_token());
+    ASSERT_EQ(value, lexer_view.get_integer()) << text;
+  }
+
+  for(std::string_view text : { "2147483648", "-2147483649", "4294967296", "99999999999999999999" })
+  {
+    sexp::Lexer lexer(text);
+    ASSERT_EQ(sexp::Lexer::TOKEN_INTEGER, lexer.get_next_token());
+    ASSERT_THROW(lexer.get_integer(), std::out_of_range) << text;
+  }
+}
+
 TEST(LexerTest, token_real)
 {
   std::vector<std::string> texts = {
     ".1234",
     ".1234e15",
+    ".5",
+    "-.5e3",
     "1234.6789",
     "1234.",
     "1234.5678",
@@ -139,4 +180,162 @@ TEST(LexerTest, token_real)
   }
 }
 
+TEST(LexerTest, real_value)
+{
+  sexp::Lexer lexer(std::string_view("1.5 -0.25 +2e3 .25"));
+  for(float value : { 1.5F, -0.25F, 2000.0F, 0.25F })
+  {
+    ASSERT_EQ(sexp::Lexer::TOKEN_REAL, lexer.get_next_token());
+    ASSERT_EQ(value, lexer.get_real());
+  }
+}
+
+TEST(LexerTest, long_strings_and_comments)
+{
+  // runs crossing the buffer boundary of a stream
+  std::string const text = std::string(40000, 'x') + "\n" + std::string(20000, 'y');
+  std::string const input =
+    ";" + std::string(40000, 'c') + "\n" +
+    "\"" + std::string(40000, 'x') + "\\n" + std::string(20000, 'y') + "\" " +
+    ";" + std::string(30000, 'c') + "\n" +
+    "\"a\nb\"";
+
+  std::istringstream is(input);
+  sexp::Lexer lexer(is);
+  sexp::Lexer lexer_view(input);
+  for(sexp::Lexer* lex : { &lexer, &lexer_view })
+  {
+    ASSERT_EQ(sexp::Lexer::TOKEN_STRING, lex->get_next_token());
+    ASSERT_EQ(1, lex->get_line_number());
+    ASSERT_EQ(text, lex->get_string_view());
+    ASSERT_EQ(sexp::Lexer::TOKEN_STRING, lex->get_next_token());
+    ASSERT_EQ(3, lex->get_line_number());
+    ASSERT_EQ("a\nb", lex->get_string_view());
+    ASSERT_EQ(sexp::Lexer::TOKEN_EOF, lex->get_next_token());
+  }
+}
+
+TEST(LexerTest, string_view_tokens)
+{
+  std::string_view text = "(foo \"bar\" 12 #t . -1.5e3)";
+  sexp::Lexer lexer(text);
+  ASSERT_EQ(sexp::Lexer::TOKEN_OPEN_PAREN, lexer.get_next_token());
+  ASSERT_EQ(sexp::Lexer::TOKEN_SYMBOL, lexer.get_next_token());
+  ASSERT_EQ("foo", lexer.get_string_view());
+  ASSERT_EQ(text.data() + 1, lexer.get_string_view().data());
+  ASSERT_EQ(sexp::Lexer::TOKEN_STRING, lexer.get_next_token());
+  ASSERT_EQ("bar", lexer.get_string_view());
+  ASSERT_EQ(text.data() + 6, lexer.get_string_view().data());
+  ASSERT_EQ(sexp::Lexer::TOKEN_INTEGER, lexer.get_next_token());
+  ASSERT_EQ("12", lexer.get_string_view());
+  ASSERT_EQ(sexp::Lexer::TOKEN_TRUE, lexer.get_next_token());
+  ASSERT_EQ(sexp::Lexer::TOKEN_DOT, lexer.get_next_token());
+  ASSERT_EQ(sexp::Lexer::TOKEN_REAL, lexer.get_next_token());
+  ASSERT_EQ("-1.5e3", lexer.get_string());
+  ASSERT_EQ(sexp::Lexer::TOKEN_CLOSE_PAREN, lexer.get_next_token());
+  ASSERT_EQ(sexp::Lexer::TOKEN_EOF, lexer.get_next_token());
+}
+
+TEST(LexerTest, string_view_escapes)
+{
+  sexp::Lexer lexer(std::string_view("\"foo\\nbar\\\"\r\n\" \"\""));
+  ASSERT_EQ(sexp::Lexer::TOKEN_STRING, lexer.get_next_token());
+  ASSERT_EQ("foo\nbar\"\n", lexer.get_string_view());
+  ASSERT_EQ(sexp::Lexer::TOKEN_STRING, lexer.get_next_token());
+  ASSERT_EQ("", lexer.get_string_view());
+  ASSERT_EQ(sexp::Lexer::TOKEN_EOF, lexer.get_next_token());
+}
+
+TEST(LexerTest, string_view_eof)
+{
+  std::vector<std::string_view> texts = {
+    "symbol",
+    "symbol;comment",
+    "symbol\n;comment",
+  };
+
+  for(const auto& text : texts)
+  {
+    sexp::Lexer lexer(text);
+    ASSERT_EQ(sexp::Lexer::TOKEN_SYMBOL, lexer.get_next_token());
+    ASSERT_EQ("symbol", lexer.get_string_view());
+    ASSERT_EQ(sexp::Lexer::TOKEN_EOF, lexer.get_next_token());
+  }
+
+  sexp::Lexer lexer(std::string_view("\"unterminated"));
+  ASSERT_THROW(lexer.get_next_token(), std::runtime_error);
+}
+
+TEST(LexerTest, string_view_large)
+{
+  // large and sparse enough to have the Lexer use the structural index
+  std::string text;
+  for(int i = 0; i < 2000; ++i) {
+    text += "(item \"a;b\\\"(c\"        ; a somewhat longer comment (with parens\n"
+            "      -12 #t #(x) \"x\"y)\n"
+            ";; ------------------------------------------------------------\n";
+  }
+
+  std::istringstream is_ref(text);
+  sexp::Lexer lexer_ref(is_ref);
+  sexp::Lexer lexer(std::string_view{text});
+  while(true) {
+    auto token = lexer.get_next_token();
+    ASSERT_EQ(lexer_ref.get_next_token(), token);
+    ASSERT_EQ(lexer_ref.get_string(), lexer.get_string_view());
+    ASSERT_EQ(lexer_ref.get_line_number(), lexer.get_line_number());
+    if (token == sexp::Lexer::TOKEN_EOF) {
+      break;
+    }
+  }
+}
+
+TEST(LexerTest, buffer_size)
+{
+  std::string const text = "(foo \"a string\" 12 -3.5 #t\n ;comment\n bar)";
+  for(size_t buffer_size : {0u, 1u, 2u, 3u, 7u, 16384u}) {
+    std::istringstream is_ref(text);
+    sexp::Lexer lexer_ref(is_ref);
+    std::istringstream is(text);
+    sexp::Lexer lexer(is, false, buffer_size);
+    while(true) {
+      auto token = lexer.get_next_token();
+      ASSERT_EQ(lexer_ref.get_next_token(), token);
+      ASSERT_EQ(lexer_ref.get_string(), lexer.get_string());
+      ASSERT_EQ(lexer_ref.get_line_number(), lexer.get_line_number());
+      if (token == sexp::Lexer::TOKEN_EOF) {
+        break;
+      }
+    }
+  }
+}
+
+TEST(LexerTest, reset)
+{
+  std::istringstream is("(foo\n bar");
+  sexp::Lexer lexer(is);
+  ASSERT_EQ(sexp::Lexer::TOKEN_OPEN_PAREN, lexer.get_next_token());
+  ASSERT_EQ(sexp::Lexer::TOKEN_SYMBOL, lexer.get_next_token());
+
+  // switching between streams and in-memory input midway
+  lexer.reset(std::string_view("baz 5"), 10);
+  ASSERT_EQ(sexp::Lexer::TOKEN_SYMBOL, lexer.get_next_token());
+  ASSERT_EQ("baz", lexer.get_string_view());
+  ASSERT_EQ(10, lexer.get_line_number());
+  ASSERT_EQ(sexp::Lexer::TOKEN_INTEGER, lexer.get_next_token());
+  ASSERT_EQ(5, lexer.get_integer());
+
+  std::istringstream is2("\n\"x\")");
+  lexer.reset(is2);
+  ASSERT_EQ(sexp::Lexer::TOKEN_STRING, lexer.get_next_token());
+  ASSERT_EQ("x", lexer.get_string());
+  ASSERT_EQ(1, lexer.get_line_number());
+  ASSERT_EQ(sexp::Lexer::TOKEN_CLOSE_PAREN, lexer.get_next_token());
+  ASSERT_EQ(sexp::Lexer::TOKEN_EOF, lexer.get_next_token());
+
+  lexer.reset(std::string_view());
+  ASSERT_EQ(sexp::Lexer::TOKEN_EOF, lexer.get_next_token());
+  ASSERT_EQ(0, lexer.get_line_number());
+}
+
 /* EOF */
@@ -0,0 +1,118 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <memory_resource>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sexp/parse_context.hpp"
+#include "sexp/parser.hpp"
+#include "sexp/value.hpp"
+
+TEST(ParseContextTest, reuse)
+{
+  std::vector<std::string> const inputs = {
+    "(foo \"bar\" 1 2.5 #t)",
+    "symbol",
+    "(a\n (b c)\n #(1 2 3))",
+    "\"a much longer string that does not fit into the small string optimization\"",
+    "  ; comment\n 42  ",
+  };
+
+  for(bool use_arrays : {false, true}) {
+    for(size_t buffer_size : {1u, 3u, 16384u}) {
+      sexp::ParseContext ctx(use_arrays, buffer_size);
+      for(int round = 0; round < 2; ++round) {
+        for(auto const& input : inputs) {
+          sexp::Value const expected = sexp::Parser::from_string(input, use_arrays);
+          ASSERT_EQ(expected, ctx.from_string_view(input));
+
+          std::istringstream is(input);
+          sexp::Value const value = ctx.from_stream(is);
+          ASSERT_EQ(expected, value);
+          ASSERT_EQ(expected.get_line(), value.get_line());
+        }
+
+        std::string const all = inputs[0] + inputs[2] + inputs[4];
+        ASSERT_EQ(sexp::Parser::from_string_many(all, use_arrays), ctx.from_string_view_many(all));
+        std::istringstream is(all);
+        ASSERT_EQ(sexp::Parser::from_string_many(all, use_arrays), ctx.from_stream_many(is));
+      }
+    }
+  }
+}
+
+TEST(ParseContextTest, errors)
+{
+  sexp::ParseContext ctx;
+  ASSERT_THROW(ctx.from_string_view("(foo (bar"), std::runtime_error);
+  ASSERT_EQ(sexp::Parser::from_string("(baz)"), ctx.from_string_view("(baz)"));
+
+  ASSERT_THROW(ctx.from_string_view("(foo) bar"), std::runtime_error);
+  ASSERT_THROW(ctx.from_string_view("\"unterminated"), std::runtime_error);
+  ASSERT_EQ(sexp::Parser::from_string("5"), ctx.from_string_view("5"));
+
+  std::istringstream is("(foo\n(bar))\n)");
+  ASSERT_THROW(ctx.from_stream_many(is), std::runtime_error);
+  std::istringstream is2("(x)");
+  ASSERT_EQ(sexp::Parser::from_string("(x)"), ctx.from_stream(is2));
+
+  // line numbers start over with every input
+  try {
+    ctx.from_string_view("\n\n(foo");
+    FAIL();
+  } catch(std::runtime_error const& err) {
+    ASSERT_EQ(std::string("Parse Error at line 2: Unexpected EOF."), err.what());
+  }
+}
+
+TEST(ParseContextTest, memory_resource)
+{
+  std::pmr::monotonic_buffer_resource resource;
+  sexp::ParseContext ctx(resource, sexp::Parser::USE_ARRAYS);
+  for(int i = 0; i < 10; ++i) {
+    ASSERT_EQ(sexp::Parser::from_string("(foo \"a long string that does not fit\" (1 2))", sexp::Parser::USE_ARRAYS),
+              ctx.from_string_view("(foo \"a long string that does not fit\" (1 2))"));
+  }
+}
+
+TEST(ParseContextTest, typed_arrays)
+{
+  sexp::ParseContext ctx;
+  ASSERT_EQ(sexp::Value::Type::ARRAY, ctx.from_string_view("#(1 2 3)").get_type());
+  ctx.set_typed_arrays(true);
+  ASSERT_EQ(sexp::Value::Type::INT_ARRAY, ctx.from_string_view("#(1 2 3)").get_type());
+}
+
+TEST(ParseContextTest, arena)
+{
+  sexp::Arena arena;
+  sexp::ParseContext ctx(arena);
+  for(int i = 0; i < 100; ++i) {
+    {
+      sexp::Value value = ctx.from_string_view("(foo \"a long string that does not fit\" (1 2 3))");
+      ASSERT_EQ(sexp::Parser::from_string("(foo \"a long string that does not fit\" (1 2 3))"), value);
+    }
+    arena.clear();
+  }
+  ASSERT_EQ(size_t{sexp::Arena::DEFAULT_CHUNK_SIZE}, arena.get_capacity());
+}
+
+/* EOF */
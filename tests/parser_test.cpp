@@ -16,7 +16,11 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
 #include <iostream>
+#include <memory_resource>
 #include <sstream>
 
 #include "sexp/io.hpp"
@@ -193,6 +197,295 @@ TEST(ParserTest, line_numbers)
   ASSERT_EQ(3, sexp::list_ref(sx, 2).get_line());
 }
 
+TEST(ParserTest, without_line_numbers)
+{
+  std::string const text = "(line1\n(line2\n\"line\n3\"))\n(line4\n.\n)";
+
+  std::istringstream is(text);
+  sexp::Lexer lexer(is);
+  sexp::Parser parser(lexer);
+  parser.set_line_numbers(false);
+
+  sexp::Value const sx = parser.read();
+  ASSERT_EQ("(line1 (line2 \"line\n3\"))", sx.str());
+  ASSERT_EQ(0, sx.get_line());
+  ASSERT_EQ(0, sexp::list_ref(sx, 1).get_line());
+  ASSERT_EQ(0, sexp::list_ref(sexp::list_ref(sx, 1), 1).get_line());
+
+  try
+  {
+    parser.read();
+    FAIL() << "expected a parse error";
+  }
+  catch(std::runtime_error const& err)
+  {
+    ASSERT_NE(std::string::npos, std::string(err.what()).find("line 6")) << err.what();
+  }
+}
+
+TEST(ParserTest, from_string_view)
+{
+  std::string_view text = "(foo\n\"bar\\tbaz\"\n(1 . 2.5) #(#t #f))";
+  sexp::Value sx = sexp::Parser::from_string_view(text);
+  ASSERT_EQ("(foo \"bar\tbaz\" (1 . 2.5) #(#t #f))", sx.str());
+
+  std::istringstream is{std::string(text)};
+  sexp::Value sx_stream = sexp::Parser::from_stream(is);
+  for(int i = 0; i < 3; ++i) {
+    ASSERT_EQ(sexp::list_ref(sx_stream, i).get_line(), sexp::list_ref(sx, i).get_line());
+  }
+
+  ASSERT_THROW(sexp::Parser::from_string_view("(foo) bar"), std::runtime_error);
+  ASSERT_THROW(sexp::Parser::from_string_view("(foo"), std::runtime_error);
+}
+
+TEST(ParserTest, from_string_view_many)
+{
+  std::vector<sexp::Value> values = sexp::Parser::from_string_view_many("1 (2) three ; comment");
+  ASSERT_EQ(3, values.size());
+  ASSERT_EQ(1, values[0].as_int());
+  ASSERT_EQ("(2)", values[1].str());
+  ASSERT_EQ("three", values[2].as_string());
+}
+
+TEST(ParserTest, typed_arrays)
+{
+  // off by default
+  ASSERT_EQ(2, sexp::Parser::from_string("#(1 2 3)").as_array()[1].as_int());
+  ASSERT_EQ(2.5f, sexp::Parser::from_string("#(1.5 2.5)").as_array()[1].as_float());
+
+  sexp::Lexer lexer(std::string_view("(#(1 2 3) (0.5 -1.5) #(1 2.5) #(a 1))"), sexp::Parser::USE_ARRAYS);
+  sexp::Parser parser(lexer);
+  parser.set_typed_arrays(true);
+  sexp::Value sx = parser.read();
+  ASSERT_EQ(sexp::Value::Type::ARRAY, sx.get_type());
+  auto const& items = sx.as_array();
+  ASSERT_EQ(sexp::Value::Type::INT_ARRAY, items[0].get_type());
+  ASSERT_EQ(sexp::Value::Type::REAL_ARRAY, items[1].get_type());
+  ASSERT_EQ(-1.5f, items[1].as_real_array()[1]);
+  ASSERT_EQ(sexp::Value::Type::ARRAY, items[2].get_type());
+  ASSERT_EQ(sexp::Value::Type::ARRAY, items[3].get_type());
+  ASSERT_EQ("#(#(1 2 3) #(0.5 -1.5) #(1 2.5) #(a 1))", sx.str());
+
+  sexp::Arena arena;
+  sexp::Lexer arena_lexer(std::string_view("#(1 2 3)"));
+  sexp::Parser arena_parser(arena_lexer, arena);
+  arena_parser.set_typed_arrays(true);
+  ASSERT_TRUE(arena_parser.read().is_int_array());
+}
+
+TEST(ParserTest, from_string_use_arrays)
+{
+  sexp::Value sx = sexp::Parser::from_string("(1 (2 3))", sexp::Parser::USE_ARRAYS);
+  ASSERT_TRUE(sx.is_array());
+  ASSERT_EQ("#(1 #(2 3))", sx.str());
+}
+
+TEST(ParserTest, from_file)
+{
+  std::ifstream fin("benchmarks/test.sexp");
+  sexp::Value expected = sexp::Parser::from_stream(fin);
+  sexp::Value sx = sexp::Parser::from_file("benchmarks/test.sexp");
+  ASSERT_EQ(expected, sx);
+  ASSERT_EQ(expected.get_car().get_line(), sx.get_car().get_line());
+
+  std::vector<sexp::Value> values = sexp::Parser::from_file_many("benchmarks/test.sexp");
+  ASSERT_EQ(1, values.size());
+  ASSERT_EQ(expected, values[0]);
+
+  ASSERT_THROW(sexp::Parser::from_file("benchmarks/does-not-exist.sexp"), std::runtime_error);
+}
+
+#ifndef _WIN32
+TEST(ParserTest, from_file_non_regular)
+{
+  // /dev/null can't be mapped and goes through the stream fallback
+  ASSERT_TRUE(sexp::Parser::from_file_many("/dev/null").empty());
+  ASSERT_THROW(sexp::Parser::from_file("/dev/null"), std::runtime_error);
+}
+#endif
+
+TEST(ParserTest, deep_nesting)
+{
+  int const depth = 200000;
+  std::string const text = std::string(depth, '(') + "x" + std::string(depth, ')');
+
+  sexp::Value sx = sexp::Parser::from_string(text);
+  sexp::Value const* cur = &sx;
+  for(int i = 0; i < depth; ++i) {
+    ASSERT_TRUE(cur->is_cons());
+    ASSERT_TRUE(cur->get_cdr().is_nil());
+    cur = &cur->get_car();
+  }
+  ASSERT_EQ("x", cur->as_string());
+
+  sexp::Value arr = sexp::Parser::from_string(text, sexp::Parser::USE_ARRAYS);
+  ASSERT_TRUE(arr.is_array());
+}
+
+TEST(ParserTest, max_depth)
+{
+  {
+    sexp::Lexer lexer(std::string_view("((1) (2 (3)))"));
+    sexp::Parser parser(lexer, 2);
+    ASSERT_THROW(parser.read_many(), std::runtime_error);
+  }
+
+  {
+    sexp::Lexer lexer(std::string_view("((1) (2 . 3))"));
+    sexp::Parser parser(lexer, 2);
+    ASSERT_EQ("((1) (2 . 3))", parser.read_many().at(0).str());
+  }
+}
+
+TEST(ParserTest, arena)
+{
+  std::string const text = "(foo (bar 5) \"text\" #(1 2.5 (baz)))\n\"x\"";
+  sexp::Arena arena;
+  for(bool use_arrays : { false, true })
+  {
+    std::vector<sexp::Value> expected = sexp::Parser::from_string_many(text, use_arrays);
+    std::vector<sexp::Value> result = sexp::Parser::from_string_many(text, arena, use_arrays);
+    ASSERT_EQ(expected, result);
+    for(size_t i = 0; i < expected.size(); ++i)
+    {
+      ASSERT_EQ(expected[i].get_line(), result[i].get_line());
+    }
+
+    std::istringstream in(text);
+    ASSERT_EQ(expected, sexp::Parser::from_stream_many(in, arena, use_arrays));
+  }
+  ASSERT_THROW(sexp::Parser::from_string("(foo", arena), std::runtime_error);
+}
+
+TEST(ParserTest, memory_resource)
+{
+  std::string const text = "(foo (bar 5) \"a string that is too long to be inline\" #(1 2.5 (baz)))\n\"x\"";
+  for(bool use_arrays : { false, true })
+  {
+    std::pmr::monotonic_buffer_resource resource;
+    std::vector<sexp::Value> expected = sexp::Parser::from_string_many(text, use_arrays);
+    std::vector<sexp::Value> result = sexp::Parser::from_string_many(text, resource, use_arrays);
+    ASSERT_EQ(expected, result);
+    for(size_t i = 0; i < expected.size(); ++i)
+    {
+      ASSERT_EQ(expected[i].get_line(), result[i].get_line());
+    }
+
+    std::istringstream in(text);
+    sexp::Lexer lexer(in, use_arrays);
+    sexp::Parser parser(lexer, resource);
+    ASSERT_EQ(expected, parser.read_many());
+  }
+
+  // everything is taken from the resource, nothing is given back
+  struct Counting : public std::pmr::memory_resource
+  {
+    size_t allocated = 0;
+    size_t deallocated = 0;
+    void* do_allocate(size_t bytes, size_t align) override {
+      allocated += 1;
+      return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t align) override {
+      deallocated += 1;
+      std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+      return this == &other;
+    }
+  };
+  Counting counting;
+  {
+    std::pmr::monotonic_buffer_resource monotonic(&counting);
+    std::vector<sexp::Value> values = sexp::Parser::from_string_many(text, monotonic);
+    ASSERT_LT(0u, counting.allocated);
+    ASSERT_THROW(sexp::Parser::from_string("(foo", monotonic), std::runtime_error);
+  }
+  ASSERT_EQ(counting.allocated, counting.deallocated);
+}
+
+TEST(ParserTest, from_string_view_many_parallel)
+{
+  std::string text;
+  for(int i = 0; text.size() < 3 * 1024 * 1024; ++i)
+  {
+    text += "(entry (id " + std::to_string(i) + ") (name \"a (b\") ; c ) d\n  (values 1.5 #t sym))\n";
+  }
+
+  std::vector<sexp::Value> const expected = sexp::Parser::from_string_view_many(text);
+  std::vector<sexp::Value> const result = sexp::Parser::from_string_view_many_parallel(text, false, 4);
+  ASSERT_EQ(expected.size(), result.size());
+  for(size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[i], result[i]);
+    ASSERT_EQ(expected[i].get_line(), result[i].get_line());
+    ASSERT_EQ(expected[i].get_cdr().get_car().get_line(), result[i].get_cdr().get_car().get_line());
+  }
+
+  // errors are the same as those of the serial parser
+  for(std::string const error : { "(foo))\n", "(foo #z)\n" })
+  {
+    std::string const broken = text + error + text;
+    std::string expected_error;
+    try {
+      sexp::Parser::from_string_view_many(broken);
+    } catch(std::exception const& err) {
+      expected_error = err.what();
+    }
+    try {
+      sexp::Parser::from_string_view_many_parallel(broken, false, 4);
+      FAIL() << "no error";
+    } catch(std::exception const& err) {
+      ASSERT_EQ(expected_error, err.what());
+    }
+  }
+}
+
+TEST(ParserTest, forms)
+{
+  static_assert(std::input_iterator<sexp::FormRange::iterator>);
+
+  std::string const text = "(a 1)\n\n b \"c\" ; comment\n #(1 2) 5";
+  std::vector<sexp::Value> const expected = sexp::Parser::from_string_many(text);
+
+  std::istringstream in(text);
+  std::vector<sexp::Value> result;
+  for(sexp::Value& value : sexp::Parser::forms(in))
+  {
+    result.push_back(std::move(value));
+  }
+  ASSERT_EQ(expected, result);
+  for(size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[i].get_line(), result[i].get_line());
+  }
+
+  // standard algorithms
+  sexp::FormRange range(text);
+  result.clear();
+  std::copy(range.begin(), range.end(), std::back_inserter(result));
+  ASSERT_EQ(expected, result);
+
+  sexp::FormRange symbols(text);
+  ASSERT_EQ(1, std::count_if(symbols.begin(), symbols.end(),
+                             [](sexp::Value const& value) { return value.is_symbol(); }));
+
+  // post-increment keeps the previous form
+  sexp::FormRange range2(text);
+  auto it = range2.begin();
+  auto old = it++;
+  ASSERT_EQ(expected[0], *old);
+  ASSERT_EQ(expected[1], *it);
+
+  ASSERT_TRUE(sexp::Parser::forms(std::string_view("  ; nothing")).begin() == sexp::FormRange::iterator());
+
+  std::istringstream broken("(a) (b");
+  auto forms = sexp::Parser::forms(broken);
+  auto broken_it = forms.begin();
+  ASSERT_THROW(++broken_it, std::runtime_error);
+}
+
 // C++ locale support comes in the form of ugly global state that
 // spreads over most string formating functions, changing locale can
 // break a lot of stuff.
@@ -0,0 +1,86 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "sexp/parser.hpp"
+#include "sexp/pool.hpp"
+#include "sexp/value.hpp"
+
+TEST(PoolTest, allocate)
+{
+  std::vector<std::pair<char*, size_t> > blocks;
+  for(size_t size = 1; size <= 2 * sexp::Pool::MAX_SIZE; ++size)
+  {
+    for(int i = 0; i < 100; ++i)
+    {
+      char* ptr = static_cast<char*>(sexp::Pool::allocate(size));
+      ASSERT_EQ(0, reinterpret_cast<uintptr_t>(ptr) % sexp::Pool::ALIGNMENT);
+      memset(ptr, static_cast<int>(size), size);
+      blocks.emplace_back(ptr, size);
+    }
+  }
+
+  std::set<char*> unique;
+  for(auto const& block : blocks)
+  {
+    ASSERT_TRUE(unique.insert(block.first).second);
+    for(size_t i = 0; i < block.second; ++i) {
+      ASSERT_EQ(static_cast<char>(block.second), block.first[i]);
+    }
+    sexp::Pool::deallocate(block.first, block.second);
+  }
+}
+
+TEST(PoolTest, threads)
+{
+  // values are built in one thread and released in another, so blocks
+  // have to travel between the thread caches
+  std::vector<sexp::Value> values(8);
+  for(int round = 0; round < 4; ++round)
+  {
+    std::vector<sexp::Value> next(values.size());
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < values.size(); ++i)
+    {
+      threads.emplace_back([&values, &next, i, round]{
+        values[i] = sexp::Value::nil();
+        std::string text = "(";
+        for(int j = 0; j < 5000; ++j) {
+          text += "(item " + std::to_string(j) + " \"a string " + std::to_string(round) + "\" #(1 2))";
+        }
+        text += ")";
+        next[(i + 1) % next.size()] = sexp::Parser::from_string(text);
+      });
+    }
+    for(auto& thread : threads) {
+      thread.join();
+    }
+    values = std::move(next);
+  }
+
+  for(auto const& value : values) {
+    ASSERT_EQ("item", value.get_car().get_car().as_string());
+  }
+}
+
+/* EOF */
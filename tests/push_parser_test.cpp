@@ -0,0 +1,150 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sexp/parser.hpp"
+#include "sexp/push_parser.hpp"
+#include "sexp/value.hpp"
+
+namespace {
+
+void expect_same_lines(sexp::Value const& expected, sexp::Value const& value)
+{
+  ASSERT_EQ(expected.get_line(), value.get_line()) << expected.str();
+  if (expected.is_cons())
+  {
+    expect_same_lines(expected.get_car(), value.get_car());
+    expect_same_lines(expected.get_cdr(), value.get_cdr());
+  }
+  else if (expected.is_array() && !expected.is_int_array() && !expected.is_real_array())
+  {
+    for(size_t i = 0; i < expected.as_array().size(); ++i) {
+      expect_same_lines(expected.as_array()[i], value.as_array()[i]);
+    }
+  }
+}
+
+std::vector<sexp::Value> push_parse(std::string const& text, size_t chunk_size, bool use_arrays = false)
+{
+  sexp::PushParser parser(use_arrays);
+  std::vector<sexp::Value> result;
+  sexp::Value value;
+  for(size_t pos = 0; pos < text.size(); pos += chunk_size)
+  {
+    parser.feed(std::string_view(text).substr(pos, chunk_size));
+    while(parser.next(value)) {
+      result.push_back(std::move(value));
+    }
+  }
+  parser.finish();
+  while(parser.next(value)) {
+    result.push_back(std::move(value));
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(PushParserTest, chunks)
+{
+  std::string const base =
+    "(entry (id 1)\n (name \"a (b\\\" ;\\n\") ; c ) d\n  (values 1.5 #t sym))\n"
+    "atom\n\"string\"\n\"string\" 12 -3.5e2 #f\n;; comment (\n"
+    "#(1 2 3)(a)b\"c\"\n"
+    "  (#(x \"y\" (z))\n"
+    ")last";
+
+  for(bool use_arrays : { false, true })
+  {
+    std::string const text = use_arrays ? base : base + " (dotted . \"pair\")";
+    std::vector<sexp::Value> const expected = sexp::Parser::from_string_many(text, use_arrays);
+    for(size_t chunk_size = 1; chunk_size <= text.size(); ++chunk_size)
+    {
+      std::vector<sexp::Value> const result = push_parse(text, chunk_size, use_arrays);
+      ASSERT_EQ(expected.size(), result.size()) << chunk_size;
+      for(size_t i = 0; i < expected.size(); ++i)
+      {
+        ASSERT_EQ(expected[i], result[i]) << chunk_size;
+        expect_same_lines(expected[i], result[i]);
+      }
+    }
+  }
+}
+
+TEST(PushParserTest, incomplete)
+{
+  sexp::PushParser parser;
+  sexp::Value value;
+
+  parser.feed("(a \"b)");
+  ASSERT_FALSE(parser.next(value));
+  parser.feed("\") 12");
+  ASSERT_TRUE(parser.next(value));
+  ASSERT_EQ("(a \"b)\")", value.str());
+
+  // an atom is only complete once something follows it
+  ASSERT_FALSE(parser.next(value));
+  parser.feed("3");
+  ASSERT_FALSE(parser.next(value));
+  parser.finish();
+  ASSERT_TRUE(parser.next(value));
+  ASSERT_EQ(123, value.as_int());
+  ASSERT_FALSE(parser.next(value));
+}
+
+TEST(PushParserTest, blank_input)
+{
+  // blanks and comments are dropped right away, only their lines are
+  // remembered
+  sexp::PushParser parser;
+  sexp::Value value;
+  for(int i = 0; i < 1000; ++i)
+  {
+    parser.feed("  ; a comment (\n");
+    ASSERT_EQ(i + 1, parser.get_line_number());
+  }
+  parser.feed("; unfinished");
+  parser.feed(" comment\n\n(a\n");
+  ASSERT_EQ(1002, parser.get_line_number());
+  parser.feed(" b) ");
+  ASSERT_TRUE(parser.next(value));
+  ASSERT_EQ(1002, value.get_line());
+  ASSERT_EQ(1003, parser.get_line_number());
+  ASSERT_EQ("(a b)", value.str());
+}
+
+TEST(PushParserTest, errors)
+{
+  for(std::string_view text : { "(foo))", "(a . )", "(a . b c)" })
+  {
+    sexp::PushParser parser;
+    ASSERT_THROW(parser.feed(text), std::runtime_error) << text;
+  }
+
+  for(std::string_view text : { "(foo", "\"foo", "#(1 (2)", "#z" })
+  {
+    sexp::PushParser parser;
+    parser.feed(text);
+    ASSERT_THROW(parser.finish(), std::runtime_error) << text;
+  }
+}
+
+/* EOF */
@@ -0,0 +1,190 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sexp/parser.hpp"
+#include "sexp/reader.hpp"
+#include "sexp/value.hpp"
+
+TEST(ReaderTest, walk)
+{
+  sexp::Lexer lexer(std::string_view("(level (name \"x\") (sector (a 1)) (sector (b #t 2.5)) 5)"));
+  sexp::Reader reader(lexer);
+
+  ASSERT_TRUE(reader.next());
+  ASSERT_TRUE(reader.is_list());
+  reader.enter();
+  ASSERT_EQ(1, reader.get_depth());
+
+  ASSERT_TRUE(reader.next());
+  ASSERT_TRUE(reader.is_symbol());
+  ASSERT_EQ("level", reader.get_string_view());
+
+  std::vector<sexp::Value> sectors;
+  int count = 0;
+  while(reader.next())
+  {
+    count += 1;
+    if (reader.is_list())
+    {
+      reader.enter();
+      if (reader.next() && reader.get_string_view() == "sector")
+      {
+        ASSERT_TRUE(reader.next());
+        sectors.push_back(reader.materialize());
+      }
+      reader.leave();
+    }
+    else
+    {
+      ASSERT_TRUE(reader.is_integer());
+      ASSERT_EQ(5, reader.as_int());
+      ASSERT_EQ(5.0f, reader.as_float());
+    }
+  }
+  ASSERT_EQ(4, count);
+  ASSERT_FALSE(reader.next());
+  reader.leave();
+  ASSERT_EQ(0, reader.get_depth());
+  ASSERT_FALSE(reader.next());
+
+  ASSERT_EQ(2, sectors.size());
+  ASSERT_EQ(sexp::Parser::from_string("(a 1)"), sectors[0]);
+  ASSERT_EQ(sexp::Parser::from_string("(b #t 2.5)"), sectors[1]);
+}
+
+TEST(ReaderTest, materialize)
+{
+  std::string const text = "(a (b . c))\n\n#(1 2)\n \"str\" ; comment\n sym";
+  sexp::Lexer lexer(text);
+  sexp::Reader reader(lexer);
+
+  std::vector<sexp::Value> result;
+  while(reader.next())
+  {
+    result.push_back(reader.materialize());
+  }
+
+  std::vector<sexp::Value> const expected = sexp::Parser::from_string_many(text);
+  ASSERT_EQ(expected, result);
+  for(size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(expected[i].get_line(), result[i].get_line());
+  }
+}
+
+TEST(ReaderTest, skip)
+{
+  std::istringstream in("((1 (2 #(3))) 4) (5)");
+  sexp::Lexer lexer(in);
+  sexp::Reader reader(lexer);
+
+  ASSERT_TRUE(reader.next());
+  reader.enter();
+  reader.skip();
+  ASSERT_FALSE(reader.next());
+  reader.leave();
+
+  ASSERT_TRUE(reader.next());
+  reader.enter();
+  ASSERT_TRUE(reader.next());
+  ASSERT_EQ(5, reader.as_int());
+  reader.leave();
+  ASSERT_FALSE(reader.next());
+}
+
+TEST(ReaderTest, dotted)
+{
+  sexp::Lexer lexer(std::string_view("(a . b)"));
+  sexp::Reader reader(lexer);
+  ASSERT_TRUE(reader.next());
+  reader.enter();
+  ASSERT_TRUE(reader.next());
+  ASSERT_EQ("a", reader.get_string_view());
+  ASSERT_TRUE(reader.next());
+  ASSERT_EQ("b", reader.get_string_view());
+  ASSERT_FALSE(reader.next());
+}
+
+TEST(ReaderTest, dotted_errors)
+{
+  // the same input is rejected by Parser, whether the list is entered
+  // or skipped
+  for(std::string const text : { "(. a)", "(a . b c)", "(a . )", "(a . . b)", "#(a . b)", "#()" })
+  {
+    ASSERT_THROW(sexp::Parser::from_string(text), std::runtime_error) << text;
+
+    {
+      sexp::Lexer lexer{std::string_view(text)};
+      sexp::Reader reader(lexer);
+      ASSERT_TRUE(reader.next());
+      reader.enter();
+      ASSERT_THROW(reader.skip(), std::runtime_error) << text;
+    }
+
+    {
+      std::string const outer = "(x " + text + ")";
+      sexp::Lexer lexer{std::string_view(outer)};
+      sexp::Reader reader(lexer);
+      ASSERT_TRUE(reader.next());
+      reader.enter();
+      ASSERT_TRUE(reader.next());
+      ASSERT_TRUE(reader.next());
+      ASSERT_THROW(reader.next(), std::runtime_error) << text;
+    }
+  }
+
+  sexp::Lexer lexer(std::string_view("((a . (b)) (c . d) ())"));
+  sexp::Reader reader(lexer);
+  ASSERT_TRUE(reader.next());
+  reader.skip();
+  ASSERT_FALSE(reader.next());
+}
+
+TEST(ReaderTest, errors)
+{
+  {
+    sexp::Lexer lexer(std::string_view("(a (b)"));
+    sexp::Reader reader(lexer);
+    ASSERT_TRUE(reader.next());
+    ASSERT_THROW(reader.next(), std::runtime_error);
+  }
+
+  {
+    sexp::Lexer lexer(std::string_view("a)"));
+    sexp::Reader reader(lexer);
+    ASSERT_TRUE(reader.next());
+    ASSERT_THROW(reader.next(), std::runtime_error);
+  }
+
+  {
+    sexp::Lexer lexer(std::string_view("a"));
+    sexp::Reader reader(lexer);
+    ASSERT_THROW(reader.get_string_view(), sexp::TypeError);
+    ASSERT_TRUE(reader.next());
+    ASSERT_THROW(reader.enter(), sexp::TypeError);
+    ASSERT_THROW(reader.as_int(), sexp::TypeError);
+    ASSERT_THROW(reader.leave(), std::logic_error);
+  }
+}
+
+/* EOF */
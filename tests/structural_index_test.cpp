@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "structural_index.hpp"
+
+namespace {
+
+// straight forward byte at a time implementation to compare against
+std::vector<uint32_t> reference_index(std::string const& text)
+{
+  std::vector<uint32_t> result;
+  enum { NORMAL, STRING, COMMENT } state = NORMAL;
+  bool escape = false;
+  bool prev_atom = false;
+  for(uint32_t i = 0; i < text.size(); ++i)
+  {
+    char const c = text[i];
+    bool atom = false;
+    switch(state)
+    {
+      case STRING:
+        if (escape) {
+          escape = false;
+        } else if (c == '\\') {
+          escape = true;
+        } else if (c == '"') {
+          state = NORMAL;
+        }
+        break;
+
+      case COMMENT:
+        if (c == '\n') {
+          state = NORMAL;
+        }
+        break;
+
+      case NORMAL:
+        if (c == '(' || c == ')') {
+          result.push_back(i);
+        } else if (c == '"') {
+          result.push_back(i);
+          state = STRING;
+        } else if (c == ';') {
+          state = COMMENT;
+        } else if (!isspace(c)) {
+          atom = true;
+          if (!prev_atom) {
+            result.push_back(i);
+          }
+        }
+        break;
+    }
+    prev_atom = atom;
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(StructuralIndexTest, simple)
+{
+  std::string text = "(foo \"b(a)r\" ;c(o)mment\n 12 #(x))";
+  std::vector<uint32_t> expected = { 0, 1, 5, 25, 28, 29, 30, 31, 32 };
+  ASSERT_EQ(expected, sexp::StructuralIndex(text).get_starts());
+}
+
+TEST(StructuralIndexTest, escapes)
+{
+  std::string text = "\"a\\\"b\" \"\\\\\" x";
+  std::vector<uint32_t> expected = { 0, 7, 12 };
+  ASSERT_EQ(expected, sexp::StructuralIndex(text).get_starts());
+}
+
+TEST(StructuralIndexTest, random)
+{
+  std::mt19937 rng(1234);
+  std::string const alphabet = "()\"\\; \n#abc";
+  std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+  std::uniform_int_distribution<size_t> length(0, 400);
+
+  for(int run = 0; run < 500; ++run)
+  {
+    std::string text(length(rng), ' ');
+    for(auto& c : text) {
+      c = alphabet[pick(rng)];
+    }
+    sexp::StructuralIndex const index(text);
+    ASSERT_EQ(reference_index(text), index.get_starts()) << text;
+
+    size_t const begin = text.size() / 3;
+    ASSERT_EQ(std::count(text.begin() + static_cast<long>(begin), text.end(), '\n'),
+              index.count_newlines(begin, text.size()));
+  }
+}
+
+TEST(StructuralIndexTest, split_top_level)
+{
+  std::string text;
+  for(int i = 0; i < 200; ++i)
+  {
+    text += "(form " + std::to_string(i) + " \"str ) (\" ; comment )\n #(1 2) (nested (list)))\n";
+    text += (i % 3 == 0) ? "atom " : "";
+    text += (i % 5 == 0) ? "#(a)" : "";
+  }
+
+  std::vector<sexp::FormBoundary> const pieces = sexp::split_top_level(text, 500);
+  ASSERT_LT(10, pieces.size());
+  ASSERT_EQ(0, pieces[0].offset);
+  for(size_t i = 1; i < pieces.size(); ++i)
+  {
+    size_t const offset = pieces[i].offset;
+    ASSERT_LE(pieces[i - 1].offset + 500, offset);
+    ASSERT_TRUE(text[offset] == '(' || text.compare(offset, 4, "atom") == 0 || text.compare(offset, 2, "#(") == 0)
+      << text.substr(offset, 10);
+    ASSERT_EQ(std::count(text.begin(), text.begin() + static_cast<long>(offset), '\n'), pieces[i].line);
+  }
+
+  // malformed input is left in one piece
+  ASSERT_EQ(1, sexp::split_top_level(text + "(", 500).size());
+  ASSERT_EQ(1, sexp::split_top_level(")" + text, 500).size());
+  ASSERT_EQ(1, sexp::split_top_level(text + "\"", 500).size());
+}
+
+/* EOF */
@@ -0,0 +1,130 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sexp/parser.hpp"
+#include "sexp/symbol_table.hpp"
+#include "sexp/util.hpp"
+#include "sexp/value.hpp"
+
+TEST(SymbolTableTest, intern)
+{
+  std::string const* foo = sexp::SymbolTable::intern("symbol-table-test-foo");
+  ASSERT_EQ("symbol-table-test-foo", *foo);
+  ASSERT_EQ(foo, sexp::SymbolTable::intern(std::string("symbol-table-test-foo")));
+  ASSERT_EQ(foo, sexp::SymbolTable::find("symbol-table-test-foo"));
+  ASSERT_NE(foo, sexp::SymbolTable::intern("symbol-table-test-bar"));
+  ASSERT_EQ(nullptr, sexp::SymbolTable::find("symbol-table-test-never-interned"));
+}
+
+TEST(SymbolTableTest, values)
+{
+  sexp::Value const a = sexp::Parser::from_string("(foo bar)");
+  sexp::Value const b = sexp::Parser::from_string("(foo \"foo\")");
+  ASSERT_EQ(a.get_car().as_string_view().data(), b.get_car().as_string_view().data());
+  ASSERT_EQ(a.get_car(), b.get_car());
+  ASSERT_NE(b.get_car(), b.get_cdr().get_car());
+
+  sexp::Value const copy = a;
+  ASSERT_EQ(a.get_car().as_string_view().data(), copy.get_car().as_string_view().data());
+
+  // looking up an unknown key must not add it to the table
+  size_t const size = sexp::SymbolTable::size();
+  ASSERT_TRUE(sexp::assoc_ref(sexp::Parser::from_string("((foo 1))"), "symbol-table-test-unknown").is_nil());
+  ASSERT_EQ(size, sexp::SymbolTable::size());
+  ASSERT_EQ(nullptr, sexp::SymbolTable::find("symbol-table-test-unknown"));
+}
+
+TEST(SymbolTableTest, max_size)
+{
+  // parsing ever new symbols doesn't grow the table past its limit
+  size_t const max_size = sexp::SymbolTable::size() + 10;
+  sexp::SymbolTable::set_max_size(max_size);
+  for(int round = 0; round < 10; ++round)
+  {
+    std::string text = "(";
+    for(int i = 0; i < 100; ++i) {
+      text += " symbol-table-test-max-size-" + std::to_string(round) + "-" + std::to_string(i);
+    }
+    text += ")";
+    sexp::Value const value = sexp::Parser::from_string(text);
+    ASSERT_EQ(text.substr(0, 1) + text.substr(2), value.str());
+    ASSERT_EQ(max_size, sexp::SymbolTable::size());
+  }
+
+  // names that didn't fit still behave like symbols
+  sexp::Value const a = sexp::Value::symbol("symbol-table-test-max-size-overflow");
+  sexp::Value b = sexp::Value::symbol("symbol-table-test-max-size-overflow");
+  ASSERT_EQ(nullptr, sexp::SymbolTable::find("symbol-table-test-max-size-overflow"));
+  ASSERT_EQ(a, b);
+  ASSERT_NE(a, sexp::Value::symbol("symbol-table-test-max-size-other"));
+  ASSERT_NE(a, sexp::Value::string("symbol-table-test-max-size-overflow"));
+  ASSERT_TRUE(b.is_symbol());
+  b.share();
+  sexp::Value const copy = b;
+  ASSERT_EQ(a, copy);
+  ASSERT_EQ("symbol-table-test-max-size-overflow", copy.as_string_view());
+  ASSERT_EQ(2, sexp::assoc_ref(sexp::Parser::from_string("((foo 1) (symbol-table-test-max-size-overflow 2))"),
+                               "symbol-table-test-max-size-overflow").get_car().as_int());
+  ASSERT_EQ(1, sexp::assoc_ref(sexp::Parser::from_string("((foo 1))"), "foo").get_car().as_int());
+
+  sexp::SymbolTable::set_max_size(sexp::SymbolTable::DEFAULT_MAX_SIZE);
+}
+
+TEST(SymbolTableTest, interned_after_overflow)
+{
+  // a symbol created while the table was full keeps its own copy of
+  // the name, even after the name got interned later on
+  sexp::SymbolTable::set_max_size(sexp::SymbolTable::size());
+  sexp::Value const alist = sexp::Parser::from_string("((symbol-table-test-late 1))");
+  ASSERT_EQ(nullptr, sexp::SymbolTable::find("symbol-table-test-late"));
+
+  sexp::SymbolTable::set_max_size(sexp::SymbolTable::DEFAULT_MAX_SIZE);
+  sexp::Value const late = sexp::Value::symbol("symbol-table-test-late");
+  ASSERT_NE(nullptr, sexp::SymbolTable::find("symbol-table-test-late"));
+  ASSERT_EQ(late, alist.get_car().get_car());
+  ASSERT_EQ(1, sexp::assoc_ref(alist, "symbol-table-test-late").get_car().as_int());
+}
+
+TEST(SymbolTableTest, threads)
+{
+  std::vector<std::vector<std::string const*> > results(4);
+  std::vector<std::thread> threads;
+  for(auto& result : results)
+  {
+    threads.emplace_back([&result]{
+      for(int i = 0; i < 1000; ++i) {
+        result.push_back(sexp::SymbolTable::intern("symbol-table-test-" + std::to_string(i)));
+      }
+    });
+  }
+  for(auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  for(auto const& result : results)
+  {
+    ASSERT_EQ(results[0], result);
+  }
+}
+
+/* EOF */
@@ -0,0 +1,177 @@
+// SExp - A S-Expression Parser for C++
+// Copyright (C) 2026 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sexp/parser.hpp"
+#include "sexp/tape_document.hpp"
+#include "sexp/util.hpp"
+#include "sexp/value.hpp"
+
+namespace {
+
+// walks both trees and compares every node with the one built by the
+// Parser, the rest of a list has no line of its own in a Value
+void compare(sexp::Value const& expected, sexp::NodeRef const& node, bool rest = false)
+{
+  ASSERT_EQ(expected, node.to_value()) << expected.str() << " != " << node.to_value().str();
+  ASSERT_EQ(expected.get_type(), node.get_type());
+  if (!rest || !expected.is_cons())
+  {
+    ASSERT_EQ(expected.get_line(), node.get_line());
+  }
+  if (expected.is_cons())
+  {
+    compare(expected.get_car(), node.get_car());
+    compare(expected.get_cdr(), node.get_cdr(), true);
+  }
+  else if (expected.is_array())
+  {
+    ASSERT_EQ(expected.as_array().size(), node.get_array_size());
+    for(size_t i = 0; i < expected.as_array().size(); ++i)
+    {
+      compare(expected.as_array()[i], node.array_ref(static_cast<int>(i)));
+    }
+  }
+}
+
+} // namespace
+
+TEST(TapeDocumentTest, navigation)
+{
+  std::string const text = "(level (name \"x\") ; (name \"y\")\n (size 10 . 20) ()\n (data #(1 2.5 #t) \"a)\\\"b\"))\n(second)";
+  sexp::TapeDocument const doc = sexp::TapeDocument::from_string_view(text);
+  sexp::NodeRef const root = doc.get_root();
+
+  ASSERT_TRUE(sexp::car(root).is_symbol("level"));
+  ASSERT_FALSE(sexp::car(root).is_symbol("lev"));
+  ASSERT_EQ("x", sexp::assoc_ref(sexp::cdr(root), "name").get_car().as_string_view());
+  ASSERT_EQ(10, sexp::assoc_ref(sexp::cdr(root), "size").get_car().as_int());
+  ASSERT_EQ(20, sexp::assoc_ref(sexp::cdr(root), "size").get_cdr().as_int());
+  ASSERT_TRUE(sexp::assoc_ref(sexp::cdr(root), "missing").is_nil());
+  ASSERT_TRUE(sexp::list_ref(root, 3).is_nil());
+  ASSERT_EQ(5, sexp::list_length(root));
+  ASSERT_TRUE(sexp::is_list(root));
+  ASSERT_FALSE(sexp::is_list(sexp::list_ref(root, 2)));
+  ASSERT_THROW(sexp::list_length(sexp::list_ref(root, 2)), sexp::TypeError);
+
+  sexp::NodeRef const data = sexp::assoc_ref(sexp::cdr(root), "data").get_car();
+  ASSERT_EQ(3, data.get_array_size());
+  ASSERT_EQ(2.5f, data.array_ref(1).as_float());
+  ASSERT_THROW(data.array_ref(3), std::out_of_range);
+
+  std::vector<std::string> names;
+  for(sexp::NodeRef const& item : sexp::NodeListAdapter(root))
+  {
+    names.emplace_back(item.is_cons() ? item.get_car().as_string_view() : "-");
+  }
+  ASSERT_EQ((std::vector<std::string>{ "-", "name", "size", "-", "data" }), names);
+
+  // the cdr of a dotted list is left out as with ListAdapter
+  int count = 0;
+  for(sexp::NodeRef const& item : sexp::NodeListAdapter(sexp::list_ref(root, 2)))
+  {
+    ASSERT_TRUE(item.is_integer() || item.is_symbol());
+    count += 1;
+  }
+  ASSERT_EQ(2, count);
+
+  // a cdr that is a list is followed as with ListAdapter
+  sexp::TapeDocument const nested = sexp::TapeDocument::from_string_view("(a . (b . (c . (d . e))))");
+  std::vector<std::string> items;
+  for(sexp::NodeRef const& item : sexp::NodeListAdapter(nested.get_root()))
+  {
+    items.emplace_back(item.as_string_view());
+  }
+  ASSERT_EQ((std::vector<std::string>{ "a", "b", "c", "d" }), items);
+
+  sexp::TapeDocument const pair = sexp::TapeDocument::from_string_view("(a . (b c))");
+  count = 0;
+  for(sexp::NodeRef const& item : sexp::NodeListAdapter(pair.get_root()))
+  {
+    ASSERT_TRUE(item.is_symbol());
+    count += 1;
+  }
+  ASSERT_EQ(sexp::list_length(pair.get_root()), count);
+  ASSERT_EQ(3, count);
+
+  std::vector<sexp::Value> const expected = sexp::Parser::from_string_many(text);
+  compare(expected[0], root);
+  compare(sexp::Value::list(sexp::Value(expected[0]), sexp::Value(expected[1])), doc.get_forms());
+
+  ASSERT_THROW(root.get_car().get_car(), sexp::TypeError);
+  ASSERT_THROW(root.get_car().as_int(), sexp::TypeError);
+}
+
+TEST(TapeDocumentTest, tree_adapter)
+{
+  sexp::TapeDocument const doc = sexp::TapeDocument::from_string_view("(a (b 1) () . #(2 3))");
+  std::vector<std::string> nodes;
+  for(sexp::NodeRef const& node : sexp::NodeTreeAdapter(doc.get_root()))
+  {
+    nodes.push_back(node.is_cons() || node.is_array() ? "" : node.to_value().str());
+  }
+  ASSERT_EQ((std::vector<std::string>{ "", "a", "", "b", "1", "()", "", "2", "3" }), nodes);
+
+  nodes.clear();
+  for(sexp::NodeRef const& node : sexp::NodeTreeAdapter(doc.get_root().get_cdr().get_cdr()))
+  {
+    nodes.push_back(node.to_value().str());
+  }
+  ASSERT_EQ((std::vector<std::string>{ "()", "#(2 3)", "2", "3" }), nodes);
+
+  ASSERT_EQ(sexp::NodeTreeIterator(), sexp::NodeTreeAdapter(sexp::NodeRef()).begin());
+}
+
+TEST(TapeDocumentTest, from_value)
+{
+  for(bool use_arrays : { false, true })
+  {
+    sexp::Value const expected = sexp::Parser::from_file("benchmarks/test.sexp", use_arrays);
+    ASSERT_EQ(expected, sexp::TapeDocument::from_value(expected).get_root().to_value());
+    ASSERT_EQ(expected, sexp::TapeDocument::from_file("benchmarks/test.sexp", use_arrays).get_root().to_value());
+  }
+
+  sexp::Value const dotted = sexp::Parser::from_string("(1 (2 . #(3 (4))) . \"five\")");
+  compare(dotted, sexp::TapeDocument::from_value(dotted).get_root());
+  compare(sexp::Value::integer(5), sexp::TapeDocument::from_value(sexp::Value::integer(5)).get_root());
+}
+
+TEST(TapeDocumentTest, deep_nesting)
+{
+  int const depth = 100000;
+  std::string const text = std::string(depth, '(') + "x" + std::string(depth, ')');
+  sexp::TapeDocument const doc = sexp::TapeDocument::from_string_view(text);
+  ASSERT_EQ(static_cast<size_t>(depth + 2), doc.size());
+
+  sexp::Value const value = doc.get_root().to_value();
+  ASSERT_EQ(static_cast<size_t>(depth + 2), sexp::TapeDocument::from_value(value).size());
+}
+
+TEST(TapeDocumentTest, errors)
+{
+  ASSERT_THROW(sexp::TapeDocument::from_string_view("(a (b)"), std::runtime_error);
+  ASSERT_THROW(sexp::TapeDocument::from_string_view("(a . b c)"), std::runtime_error);
+  ASSERT_THROW(sexp::TapeDocument::from_string_view("(a #())"), std::runtime_error);
+  ASSERT_TRUE(sexp::TapeDocument::from_string_view("").get_root().is_nil());
+  ASSERT_TRUE(sexp::TapeDocument::from_string_view("").get_forms().is_nil());
+}
+
+/* EOF */
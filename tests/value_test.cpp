@@ -16,8 +16,11 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <sstream>
 #include <stdint.h>
+#include <thread>
+#include <utility>
 
 #include "sexp/value.hpp"
 #include "sexp/parser.hpp"
@@ -53,6 +56,40 @@ TEST(ValueTest, construct_string)
   ASSERT_EQ("HelloWorld", sx.as_string());
 }
 
+TEST(ValueTest, construct_short_string)
+{
+  for(std::string text : std::vector<std::string>{ "", "a", "key", "1234567", "12345678", std::string("a\0b", 3) })
+  {
+    auto sx = sexp::Value::string(text);
+    ASSERT_EQ(text, sx.as_string_view());
+    ASSERT_EQ(text, sx.as_string());
+
+    sexp::Value copy(sx);
+    sexp::Value moved(std::move(sx));
+    ASSERT_EQ(text, copy.as_string_view());
+    ASSERT_EQ(text, moved.as_string_view());
+    ASSERT_EQ(copy, moved);
+  }
+  ASSERT_NE(sexp::Value::string("key"), sexp::Value::string("keys"));
+  ASSERT_NE(sexp::Value::string("key"), sexp::Value::symbol("key"));
+  ASSERT_EQ("\"a\\\"b\"", sexp::Value::string("a\"b").str());
+
+  // short strings must not end up in the symbol table
+  ASSERT_EQ("q7z", sexp::Value::string("q7z").as_string());
+  ASSERT_EQ(nullptr, sexp::SymbolTable::find("q7z"));
+
+  // as_string() copies, earlier views stay valid and the line is kept
+  sexp::Value sx = sexp::Value::string("abc");
+  sx.set_line(42);
+  sexp::Value const& ref = sx;
+  std::string_view view = ref.as_string_view();
+  ASSERT_EQ("abc", ref.as_string());
+  ASSERT_EQ(view.data(), ref.as_string_view().data());
+  ASSERT_EQ("abc", view);
+  ASSERT_EQ(42, sx.get_line());
+  ASSERT_EQ(sexp::Value::string("abc"), sx);
+}
+
 TEST(ValueTest, construct_array)
 {
   auto sx = sexp::Value::array(sexp::Value::integer(1),
@@ -62,6 +99,51 @@ TEST(ValueTest, construct_array)
   ASSERT_EQ("#(1 2 3 4)", sx.str());
   sx.append(sexp::Value::integer(5));
   ASSERT_EQ("#(1 2 3 4 5)", sx.str());
+
+  auto const& items = sx.as_array();
+  ASSERT_EQ(5u, items.size());
+  ASSERT_EQ(1, items.front().as_int());
+  ASSERT_EQ(3, items.at(2).as_int());
+  ASSERT_EQ(5, items.back().as_int());
+}
+
+TEST(ValueTest, construct_typed_array)
+{
+  auto ints = sexp::Value::int_array({ 1, 2, 3 });
+  ASSERT_TRUE(ints.is_array());
+  ASSERT_TRUE(ints.is_int_array());
+  ASSERT_EQ(sexp::Value::Type::INT_ARRAY, ints.get_type());
+  ASSERT_EQ(3, ints.get_array_size());
+  ASSERT_EQ(2, ints.as_int_array()[1]);
+  ASSERT_EQ("#(1 2 3)", ints.str());
+  ASSERT_THROW(ints.as_array(), sexp::TypeError);
+  ASSERT_THROW(ints.as_real_array(), sexp::TypeError);
+
+  // typed and generic arrays with the same numbers are equal
+  auto const generic = sexp::Value::array(sexp::Value::integer(1), sexp::Value::integer(2), sexp::Value::integer(3));
+  ASSERT_EQ(generic, ints);
+  ASSERT_EQ(ints, generic);
+  ASSERT_NE(sexp::Value::real_array({ 1.0f, 2.0f, 3.0f }), ints);
+  ASSERT_NE(sexp::Value::array(sexp::Value::integer(1), sexp::Value::integer(2)), ints);
+
+  sexp::Value copy = ints; // NOLINT
+  copy.as_int_array()[0] = 7;
+  copy.append(sexp::Value::integer(4));
+  ASSERT_TRUE(copy.is_int_array());
+  ASSERT_EQ("#(7 2 3 4)", copy.str());
+  ASSERT_EQ("#(1 2 3)", ints.str());
+
+  // anything else turns it into a generic array
+  copy.append(sexp::Value::real(5.5f));
+  ASSERT_EQ(sexp::Value::Type::ARRAY, copy.get_type());
+  ASSERT_EQ("#(7 2 3 4 5.5)", copy.str());
+
+  auto reals = sexp::Value::real_array({ 0.5f, 1.5f });
+  ASSERT_EQ("#(0.5 1.5)", reals.str());
+  reals.make_generic_array();
+  ASSERT_EQ(sexp::Value::Type::ARRAY, reals.get_type());
+  ASSERT_EQ(sexp::Value::real(1.5f), reals.as_array()[1]);
+  ASSERT_THROW(sexp::Value::integer(5).make_generic_array(), sexp::TypeError);
 }
 
 TEST(ValueTest, construct_cons)
@@ -99,6 +181,124 @@ TEST(ValueTest, assignment)
   ASSERT_EQ(lhs, rhs);
 }
 
+TEST(ValueTest, long_list)
+{
+  sexp::Value sx;
+  for(int i = 0; i < 1000000; ++i) {
+    sx = sexp::Value::cons(sexp::Value::integer(i), std::move(sx));
+  }
+
+  sexp::Value sx_copy = sx; // NOLINT
+  ASSERT_EQ(sx, sx_copy);
+  sx_copy.get_car() = sexp::Value::integer(-1);
+  ASSERT_FALSE(sx == sx_copy);
+}
+
+TEST(ValueTest, deep_nesting)
+{
+  auto const build = [](std::string const& leaf) {
+    sexp::Value sx = sexp::Value::symbol(leaf);
+    for(int i = 0; i < 1000000; ++i) {
+      if (i % 3 == 0) {
+        sx = sexp::Value::array(std::move(sx), sexp::Value::integer(i));
+      } else {
+        sx = sexp::Value::cons(std::move(sx), sexp::Value::cons(sexp::Value::string("y"), sexp::Value::nil()));
+      }
+    }
+    return sx;
+  };
+
+  sexp::Value sx = build("x");
+  sexp::Value sx_copy = sx; // NOLINT
+  ASSERT_EQ(sx, sx_copy);
+  ASSERT_FALSE(sx == build("z"));
+}
+
+TEST(ValueTest, share)
+{
+  std::string const text = "(config (name \"a rather long name\") (size #(1 2 3)) (tags x y z))";
+  sexp::Value sx = sexp::Parser::from_string(text);
+  sx.share();
+  ASSERT_TRUE(sx.is_shared());
+  ASSERT_EQ(text, sx.str());
+
+  sexp::Value copy = sx; // NOLINT
+  sexp::Value const& const_sx = sx;
+  sexp::Value const& const_copy = copy;
+  ASSERT_TRUE(copy.is_shared());
+  ASSERT_EQ(&const_sx.get_car(), &const_copy.get_car());
+  ASSERT_EQ(sx, copy);
+
+  // only the path down to the modified node is copied
+  copy.set_car(sexp::Value::symbol("renamed"));
+  copy.get_cdr().get_cdr().get_car().get_cdr().get_car().append(sexp::Value::integer(4));
+  ASSERT_EQ(text, sx.str());
+  ASSERT_EQ("(renamed (name \"a rather long name\") (size #(1 2 3 4)) (tags x y z))", copy.str());
+  ASSERT_NE(&const_sx.get_car(), &const_copy.get_car());
+  ASSERT_EQ(&const_sx.get_cdr().get_car().get_car(), &const_copy.get_cdr().get_car().get_car());
+  ASSERT_EQ(&const_sx.get_cdr().get_cdr().get_cdr().get_car(), &const_copy.get_cdr().get_cdr().get_cdr().get_car());
+
+  // a modified unshared copy doesn't affect the original
+  sexp::Value deep = sexp::Value::cons(sexp::Value::integer(1), sexp::Value(sx));
+  ASSERT_FALSE(deep.is_shared());
+  deep.get_cdr().set_cdr(sexp::Value::nil());
+  ASSERT_EQ(text, sx.str());
+}
+
+TEST(ValueTest, share_threads)
+{
+  sexp::Value sx;
+  for(int i = 0; i < 100000; ++i) {
+    // alternate long heap strings and short inline ones
+    std::string text = (i % 2 == 0) ? "some string " + std::to_string(i) : "s" + std::to_string(i % 10);
+    sx = sexp::Value::cons(sexp::Value::string(text), std::move(sx));
+  }
+  sx.share();
+
+  std::vector<std::thread> threads;
+  std::atomic<int> mismatches = 0;
+  for(int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([copy = sexp::Value(sx), i]() mutable {
+      for(int j = 0; j < 1000; ++j) {
+        sexp::Value tmp = copy; // NOLINT
+        tmp.get_cdr().set_car(sexp::Value::integer(i));
+      }
+      copy = sexp::Value::nil();
+    });
+    // const reads of the same cells from several threads
+    threads.emplace_back([&sx, &mismatches]() {
+      sexp::Value const& root = sx;
+      for(int j = 0; j < 10; ++j) {
+        sexp::Value const* cur = &root;
+        for(int k = 99999; k > 99000; --k) {
+          std::string expected = (k % 2 == 0) ? "some string " + std::to_string(k) : "s" + std::to_string(k % 10);
+          if (cur->get_car().as_string() != expected) {
+            ++mismatches;
+          }
+          cur = &cur->get_cdr();
+        }
+      }
+    });
+  }
+  for(auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, mismatches);
+  ASSERT_EQ("s9", std::as_const(sx).get_car().as_string());
+  ASSERT_EQ("some string 99998", sx.get_cdr().get_car().as_string());
+
+  // destroying shared nodes doesn't recurse either
+  sexp::Value deep = sexp::Value::integer(0);
+  for(int i = 0; i < 1000000; ++i) {
+    deep = sexp::Value::cons(std::move(deep), sexp::Value::nil());
+  }
+  deep.share();
+  sexp::Value deep_copy = deep; // NOLINT
+  deep = sexp::Value::nil();
+  deep_copy = sexp::Value::nil();
+}
+
 TEST(ValueTest, type_errors_boolean)
 {
   sexp::Value sx = sexp::Value::boolean(true);
@@ -176,6 +376,63 @@ TEST(ValueTest, type_errors_cons)
   ASSERT_THROW(sx.as_string(), sexp::TypeError);
 }
 
+TEST(ValueTest, line)
+{
+  sexp::Value sx = sexp::Parser::from_string("(\"long string\"\n  sym\n  1 1.5 #t \"abc\")");
+  ASSERT_EQ(0, sx.get_line());
+  ASSERT_EQ(1, sx.get_car().get_line());
+  for(sexp::Value const* cur = &sx.get_cdr(); !cur->is_nil(); cur = &cur->get_cdr()) {
+    ASSERT_EQ(2, cur->get_car().get_line());
+  }
+
+  sexp::Value copy(sx);
+  ASSERT_EQ(1, copy.get_car().get_line());
+  ASSERT_EQ(2, copy.get_cdr().get_car().get_line());
+
+  sexp::Value atom = sexp::Value::integer(-5);
+  atom.set_line(12345);
+  ASSERT_EQ(12345, atom.get_line());
+  ASSERT_EQ(-5, atom.as_int());
+}
+
+TEST(ValueTest, line_limit)
+{
+  std::string const text = std::string(20000, '\n') + "(1 \"a long string\")";
+  sexp::Value sx = sexp::Parser::from_string(text);
+#ifdef SEXP_COMPACT_VALUE
+  // values holding a pointer only have room for 14 bits of line,
+  // larger lines saturate
+  ASSERT_EQ(16383, sx.get_line());
+  ASSERT_EQ(16383, sx.get_cdr().get_car().get_line());
+  sx.set_line(16382);
+  ASSERT_EQ(16382, sx.get_line());
+  sx.set_line(1 << 30);
+  ASSERT_EQ(16383, sx.get_line());
+  sx.set_line(-1);
+  ASSERT_EQ(0, sx.get_line());
+#else
+  ASSERT_EQ(20000, sx.get_line());
+  ASSERT_EQ(20000, sx.get_cdr().get_car().get_line());
+
+  // 32-bit systems keep 24 bits of line
+  sx.set_line((1 << 24) - 1);
+  ASSERT_EQ((1 << 24) - 1, sx.get_line());
+  ASSERT_EQ(sexp::Value::Type::CONS, sx.get_type());
+#endif
+  ASSERT_EQ(20000, sx.get_car().get_line());
+  ASSERT_EQ("a long string", sx.get_cdr().get_car().as_string_view());
+
+  // inline strings keep their line beyond 16383 in compact mode,
+  // reading them must not lose it
+  sexp::Value const str = sexp::Parser::from_string(std::string(20000, '\n') + "\"ab\"");
+  std::string_view view = str.as_string_view();
+  ASSERT_EQ(20000, str.get_line());
+  ASSERT_EQ("ab", str.as_string());
+  ASSERT_EQ(20000, str.get_line());
+  ASSERT_EQ(view.data(), str.as_string_view().data());
+  ASSERT_EQ(sexp::Value::Type::STRING, str.get_type());
+}
+
 TEST(ValueTest, object_size)
 {
 #if INTPTR_MAX == INT32_MAX
@@ -187,7 +444,11 @@ TEST(ValueTest, object_size)
 #  endif
 #elif INTPTR_MAX == INT64_MAX
   // on 64bit systems
+#  ifdef SEXP_COMPACT_VALUE
+  ASSERT_EQ(8, sizeof(sexp::Value));
+#  else
   ASSERT_EQ(16, sizeof(sexp::Value));
+#  endif
 #else
 #  error "environment is neither 32 nor 64-bit"
 #endif